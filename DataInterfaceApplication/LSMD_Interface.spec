@@ -31,7 +31,7 @@ a = Analysis(
     datas=added_data,
     hiddenimports=hidden_imports,
     hookspath=[],
-    excludes=['matplotlib', 'scipy', 'tkinter'],
+    excludes=['matplotlib', 'scipy', 'tkinter', 'pandas'],
     noarchive=False,
 )
 
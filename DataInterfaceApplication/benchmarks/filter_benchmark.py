@@ -0,0 +1,121 @@
+"""
+Filter Benchmark - Compares the vectorized filters against the original per-sample loops
+Checks outputs match within tolerance and reports time per filter on a synthetic trial
+
+Run from DataInterfaceApplication folder:
+    python benchmarks/filter_benchmark.py [--samples 12000] [--sample-rate 1200]
+"""
+
+import argparse
+import os
+import sys
+import time
+
+import numpy as np
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from utils.butterworth_filter import ButterworthFilter
+from utils.moving_average_filter import MovingAverageFilter
+from utils.notch_filter import NotchFilter
+
+TOLERANCE = 1e-6    #max absolute difference in Newtons
+
+#Original sample-by-sample direct form recursion, kept as reference
+def reference_forward(b, a, data):
+    output = np.zeros(len(data))
+    for i in range(len(data)):
+        output[i] = b[0] * data[i]
+        if i >= 1:
+            output[i] += b[1] * data[i-1] - a[1] * output[i-1]
+        if i >= 2:
+            output[i] += b[2] * data[i-2] - a[2] * output[i-2]
+    return output
+
+#Original Butterworth apply()
+def reference_butterworth(butterworth, data):
+    signal = np.array(data, dtype=float)
+    pad_len = max(100, int(7.0 * butterworth.sample_rate / butterworth.cutoff))
+    for b, a in butterworth._design_butterworth_filter():
+        left_pad = signal[1:pad_len + 1][::-1]
+        right_pad = signal[-(pad_len + 1):-1][::-1]
+        padded = np.concatenate([left_pad, signal, right_pad])
+        forward = reference_forward(b, a, padded)
+        backward = reference_forward(b, a, forward[::-1])[::-1]
+        signal = backward[pad_len:pad_len + len(data)]
+    return signal
+
+#Original notch apply()
+def reference_notch(notch, data):
+    signal = np.array(data, dtype=float)
+    for freq in [50.0, 60.0]:
+        b, a = notch._design_notch_filter(freq)
+        forward = reference_forward(b, a, signal)
+        signal = reference_forward(b, a, forward[::-1])[::-1]
+    return signal
+
+#Original moving average, sum over a sliced centred window per sample
+def reference_moving_average(moving_average, data):
+    data = list(data)
+    smoothed = []
+    half = moving_average.window_size // 2
+    for i in range(len(data)):
+        start = max(0, i - half)
+        end = min(len(data), i + half + 1)
+        window = data[start:end]
+        smoothed.append(sum(window) / len(window))
+    return np.array(smoothed)
+
+#Synthetic force trace: contraction ramp, mains pickup and noise
+def synthetic_trial(samples, sample_rate, seed=0):
+    rng = np.random.default_rng(seed)
+    t = np.arange(samples) / sample_rate
+    force = 300.0 / (1.0 + np.exp(-(t - t[-1] / 3) * 8.0))
+    mains = 4.0 * np.sin(2 * np.pi * 60.0 * t) + 2.0 * np.sin(2 * np.pi * 50.0 * t)
+    return force + mains + rng.normal(0.0, 1.5, samples)
+
+#Time a callable, best of repeats, in ms
+def best_time_ms(function, repeats):
+    best = float("inf")
+    for _ in range(repeats):
+        start = time.perf_counter()
+        function()
+        best = min(best, time.perf_counter() - start)
+    return best * 1000.0
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark vectorized filters against reference loops")
+    parser.add_argument("--samples", type=int, default=12000)
+    parser.add_argument("--sample-rate", type=float, default=1200.0)
+    parser.add_argument("--repeats", type=int, default=5)
+    args = parser.parse_args()
+
+    data = synthetic_trial(args.samples, args.sample_rate)
+    cases = [
+        ("Notch 50/60 Hz", NotchFilter(sample_rate=args.sample_rate), reference_notch),
+        ("Butterworth 20 Hz", ButterworthFilter(cutoff=20.0, sample_rate=args.sample_rate), reference_butterworth),
+        ("Butterworth 100 Hz", ButterworthFilter(cutoff=100.0, sample_rate=args.sample_rate), reference_butterworth),
+        ("Moving average 20", MovingAverageFilter(window_size=20), reference_moving_average),
+        ("Moving average 200", MovingAverageFilter(window_size=200), reference_moving_average),
+    ]
+
+    failed = False
+    print(f"{args.samples} samples at {args.sample_rate:.0f} Hz")
+    print(f"{'Filter':<22}{'Reference ms':>14}{'Engine ms':>12}{'Speed-up':>10}{'Max diff':>12}")
+    for name, filter_object, reference in cases:
+        expected = reference(filter_object, data)
+        actual = np.asarray(filter_object.apply(data))
+        difference = float(np.max(np.abs(actual - expected)))
+
+        reference_ms = best_time_ms(lambda: reference(filter_object, data), 1)
+        engine_ms = best_time_ms(lambda: filter_object.apply(data), args.repeats)
+        print(f"{name:<22}{reference_ms:>14.1f}{engine_ms:>12.2f}{reference_ms / engine_ms:>9.0f}x{difference:>12.2e}")
+
+        if difference > TOLERANCE:
+            failed = True
+            print(f"  FAIL: {name} differs from reference by {difference:.3e}")
+
+    return 1 if failed else 0
+
+if __name__ == "__main__":
+    sys.exit(main())
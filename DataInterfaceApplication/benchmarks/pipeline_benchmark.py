@@ -0,0 +1,288 @@
+"""
+Pipeline Benchmark - Cost of each host stage per second of data, in isolation and end to end
+Runs synthetic firmware output at several sample rates through:
+    decode        StreamDecoder on ~15 ms transport chunks
+    calibrate     PiecewiseLinearCalibration.adc_to_newtons_array per chunk
+    notch / butterworth / moving_average
+                  live causal filtering per chunk (process_block)
+    zero_phase    all three filters over the whole trial, as applied after stop
+    analysis      onset / RTD / peak slope over the whole trial
+    spectrum      live Welch spectrum updated at FRAME_RATE as the trial grows
+    pipeline      AcquisitionPipeline + PipelineWorker end to end (queue, decode, calibrate, filter, store)
+    append_data   dashboard append_data end to end, then update_plot offscreen and stop
+    export_csv / export_npz
+                  export of the whole trial
+
+Each stage is reported as ms of CPU per second of data (load, 1000 = a whole core) and µs per sample.
+The end to end cost gives the estimated maximum sustainable sample rate.
+Results are written as JSON. With --baseline a previous report is compared and
+stages that got slower by more than --tolerance fail the run (exit code 1).
+
+Run from DataInterfaceApplication folder:
+    python benchmarks/pipeline_benchmark.py [--rates 1200,5000,20000] [--seconds 10] [--output report.json]
+    python benchmarks/pipeline_benchmark.py --baseline report.json
+"""
+
+import argparse
+import json
+import os
+import platform
+import sys
+import tempfile
+import time
+from datetime import datetime
+
+import numpy as np
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from utils.stream_decoder import StreamDecoder
+from utils.piecewise_linear_calibration import PiecewiseLinearCalibration
+from utils.butterworth_filter import ButterworthFilter
+from utils.moving_average_filter import MovingAverageFilter
+from utils.notch_filter import NotchFilter
+from utils.device_simulator import synthetic_trace, encode_samples
+from utils.torque_analysis import analyze_trial
+from utils.spectrum_analyzer import SpectrumAnalyzer
+from utils import trial_exporter
+
+APP_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+CHUNK_INTERVAL = 0.015      #seconds of data per transport chunk, as delivered by the transport batcher
+LIMB_LENGTH_M = 0.50
+FRAME_RATE = 30             #GUI frames per second for the spectrum stage
+REGRESSION_FLOOR = 1.0      #ms per second of data, smaller slowdowns are timer noise on the cheap stages
+
+#Calibration from the app folder, or a fixed 5 point table so results do not depend on the machine
+def load_calibration():
+    calibration = PiecewiseLinearCalibration()
+    if not calibration.load_from_file(os.path.join(APP_DIR, "calibration.json")):
+        calibration.load_points([(0.0, 3.0), (101.5, 117.0), (204.5, 264.0), (303.6, 412.0), (451.8, 637.0)])
+    return calibration
+
+#Firmware output for seconds of data, split into transport sized chunks
+def synthetic_chunks(sample_rate, seconds):
+    trace = synthetic_trace(sample_rate)
+    adc = np.resize(trace, int(sample_rate * seconds))
+    per_chunk = max(1, int(sample_rate * CHUNK_INTERVAL))
+    chunks = [encode_samples(adc[i:i + per_chunk], "ascii", i) for i in range(0, len(adc), per_chunk)]
+    return adc, chunks
+
+#Filters in GUI order
+def make_filters(sample_rate):
+    return [NotchFilter(sample_rate=sample_rate), ButterworthFilter(cutoff=20.0, sample_rate=sample_rate),
+            MovingAverageFilter(window_size=20)]
+
+#Best wall time of repeats in seconds, setup runs untimed before each repeat
+def best_time(function, repeats, setup=None):
+    best = float("inf")
+    for _ in range(repeats):
+        if setup:
+            setup()
+        start = time.perf_counter()
+        function()
+        best = min(best, time.perf_counter() - start)
+    return best
+
+#Stage entry from seconds spent on samples covering data_seconds of acquisition
+def stage_result(seconds, samples, data_seconds):
+    return {
+        "ms_per_second": seconds * 1000.0 / data_seconds,
+        "us_per_sample": seconds * 1e6 / samples,
+    }
+
+#Stages that need no Qt
+def benchmark_stages(sample_rate, seconds, repeats, calibration):
+    adc, chunks = synthetic_chunks(sample_rate, seconds)
+    samples = len(adc)
+    stages = {}
+
+    def decode():
+        decoder = StreamDecoder()
+        for chunk in chunks:
+            decoder.decode(chunk)
+    stages["decode"] = best_time(decode, repeats)
+
+    adc_chunks = np.array_split(adc.astype(np.float64), len(chunks))
+    stages["calibrate"] = best_time(lambda: [calibration.adc_to_newtons_array(block) for block in adc_chunks], repeats)
+
+    force = calibration.adc_to_newtons_array(adc)
+    force_chunks = np.array_split(force, len(chunks))
+    for name, filter_object in zip(("notch", "butterworth", "moving_average"), make_filters(sample_rate)):
+        stages[name] = best_time(lambda: [filter_object.process_block(block) for block in force_chunks],
+                                 repeats, setup=filter_object.reset_stream)
+
+    def zero_phase():
+        filtered = force
+        for filter_object in make_filters(sample_rate):
+            filtered = filter_object.apply(filtered)
+    stages["zero_phase"] = best_time(zero_phase, repeats)
+
+    times = np.arange(samples) / sample_rate
+    stages["analysis"] = best_time(lambda: analyze_trial(times, force * LIMB_LENGTH_M), repeats)
+
+    spectrum = SpectrumAnalyzer(sample_rate)
+    frame_ends = np.linspace(0, samples, int(seconds * FRAME_RATE) + 1).astype(int)[1:]
+    stages["spectrum"] = best_time(lambda: [spectrum.update(force[:end], 0) for end in frame_ends],
+                                   repeats, setup=spectrum.reset)
+
+    with tempfile.TemporaryDirectory() as folder:
+        columns = {"Time (s)": times, "Torque (N·m)": force * LIMB_LENGTH_M}
+        metadata = {"Peak Torque (N·m)": float(force.max() * LIMB_LENGTH_M)}
+        stages["export_csv"] = best_time(lambda: trial_exporter.export_csv(os.path.join(folder, "trial.csv"), columns, metadata,
+                                                                             {"Time (s)": "%.6f", "Torque (N·m)": "%.2f"}), repeats)
+        stages["export_npz"] = best_time(lambda: trial_exporter.export_npz(os.path.join(folder, "trial.npz"), columns, metadata), repeats)
+
+    return {name: stage_result(value, samples, seconds) for name, value in stages.items()}, chunks, samples
+
+#AcquisitionPipeline and its worker thread end to end
+#Each chunk is drained before the next is submitted, so per-chunk overhead counts as it does live
+def benchmark_pipeline(sample_rate, seconds, repeats, calibration, chunks, samples):
+    from utils.acquisition_pipeline import AcquisitionPipeline, PipelineWorker
+
+    pipeline = AcquisitionPipeline(samples, sample_rate)
+    pipeline.piecewise_cal = calibration
+    worker = PipelineWorker(pipeline)
+    worker.start()
+
+    def setup():
+        pipeline.reset()
+        pipeline.set_filters(make_filters(sample_rate), causal=True)
+
+    def run():
+        for chunk in chunks:
+            worker.submit(chunk)
+            worker.drain()
+
+    elapsed = best_time(run, repeats, setup=setup)
+    worker.stop()
+    result = stage_result(elapsed, samples, seconds)
+    result["stages"] = {stage: pipeline.stats.totals[stage] * 1000.0 / seconds for stage in ("decode", "calibrate", "filter", "store")}
+    return result
+
+#Dashboard end to end offscreen: append_data, one plot frame, stop (zero-phase filtering and analysis)
+def benchmark_dashboard(sample_rate, seconds, calibration, chunks, samples):
+    from windows.data_acquisition_dashboard import DataAcquisitionDashboard
+    from utils.sample_store import SampleStore
+
+    dashboard = DataAcquisitionDashboard("usb")
+    dashboard.sample_rate = sample_rate
+    dashboard.piecewise_cal = calibration
+    dashboard.pipeline.sample_rate = sample_rate
+    #Store sized for the whole trial, as load_session does, the dashboard default holds 10 s at 1200 Hz
+    store = dashboard.pipeline.samples
+    dashboard.pipeline.samples = SampleStore(samples, columns=store.columns, growable=store.growable)
+    dashboard.on_start_clicked()
+    dashboard.apply_filter(make_filters(sample_rate))
+
+    start = time.perf_counter()
+    for chunk in chunks:
+        dashboard.append_data(chunk)
+        dashboard.pipeline_worker.drain()
+    append_seconds = time.perf_counter() - start
+
+    frames = 10
+    start = time.perf_counter()
+    for _ in range(frames):
+        dashboard.update_plot()
+    frame_seconds = (time.perf_counter() - start) / frames
+
+    start = time.perf_counter()
+    dashboard.on_stop_clicked()
+    stop_seconds = time.perf_counter() - start
+    dashboard.close()
+
+    result = stage_result(append_seconds, samples, seconds)
+    result["update_plot_ms"] = frame_seconds * 1000.0
+    result["render_ms_per_second"] = frame_seconds * 1000.0 * dashboard.render_frame_rate
+    result["stop_ms"] = stop_seconds * 1000.0
+    return result
+
+#Stages that got slower than baseline by more than tolerance and REGRESSION_FLOOR, as messages
+def compare(report, baseline, tolerance):
+    regressions = []
+    for rate, entry in report["rates"].items():
+        old_entry = baseline.get("rates", {}).get(rate)
+        if old_entry is None:
+            continue
+        for name, stage in list(entry["stages"].items()) + [("pipeline", entry["pipeline"])]:
+            old = old_entry["stages"].get(name) if name != "pipeline" else old_entry.get("pipeline")
+            if not old or old["us_per_sample"] <= 0:
+                continue
+            ratio = stage["us_per_sample"] / old["us_per_sample"]
+            if ratio > 1.0 + tolerance and stage["ms_per_second"] - old["ms_per_second"] > REGRESSION_FLOOR:
+                regressions.append(f"{rate} Hz {name}: {old['us_per_sample']:.3f} -> {stage['us_per_sample']:.3f} µs/sample ({ratio:.2f}x)")
+    return regressions
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark host pipeline stages at several sample rates")
+    parser.add_argument("--rates", default="1200,5000,20000", help="comma separated sample rates in Hz")
+    parser.add_argument("--seconds", type=float, default=10.0, help="seconds of synthetic data per rate")
+    parser.add_argument("--repeats", type=int, default=5, help="best of repeats per isolated stage")
+    parser.add_argument("--output", default="pipeline_benchmark.json", help="JSON report path")
+    parser.add_argument("--baseline", help="previous JSON report to compare against")
+    parser.add_argument("--tolerance", type=float, default=0.25, help="allowed slowdown vs baseline (0.25 = 25%%)")
+    parser.add_argument("--no-gui", action="store_true", help="skip the offscreen dashboard stage")
+    args = parser.parse_args()
+
+    #Qt is needed for the pipeline worker thread and the offscreen dashboard
+    os.environ.setdefault("QT_QPA_PLATFORM", "offscreen")
+    if args.no_gui:
+        from PyQt6.QtCore import QCoreApplication
+        app = QCoreApplication(sys.argv[:1])
+    else:
+        from PyQt6.QtWidgets import QApplication
+        app = QApplication(sys.argv[:1])
+
+    calibration = load_calibration()
+    report = {
+        "generated": datetime.now().isoformat(timespec="seconds"),
+        "platform": platform.platform(),
+        "python": platform.python_version(),
+        "numpy": np.__version__,
+        "seconds": args.seconds,
+        "rates": {},
+    }
+
+    for sample_rate in [int(rate) for rate in args.rates.split(",")]:
+        stages, chunks, samples = benchmark_stages(sample_rate, args.seconds, args.repeats, calibration)
+        pipeline = benchmark_pipeline(sample_rate, args.seconds, args.repeats, calibration, chunks, samples)
+
+        #Worker thread load decides the sustainable rate, assuming cost scales with sample count
+        load = pipeline["ms_per_second"] / 1000.0
+        entry = {
+            "samples": samples,
+            "stages": stages,
+            "pipeline": pipeline,
+            "max_sustainable_rate": sample_rate / load if load > 0 else None,
+        }
+        if not args.no_gui:
+            entry["dashboard"] = benchmark_dashboard(sample_rate, args.seconds, calibration, chunks, samples)
+        report["rates"][str(sample_rate)] = entry
+
+        print(f"{sample_rate} Hz, {samples} samples ({args.seconds:.0f} s of data)")
+        print(f"    {'Stage':<16}{'ms per s':>10}{'µs/sample':>12}")
+        for name, stage in list(stages.items()) + [("pipeline", pipeline)] + ([("append_data", entry["dashboard"])] if "dashboard" in entry else []):
+            print(f"    {name:<16}{stage['ms_per_second']:>10.2f}{stage['us_per_sample']:>12.3f}")
+        if "dashboard" in entry:
+            dashboard = entry["dashboard"]
+            print(f"    update_plot {dashboard['update_plot_ms']:.2f} ms/frame ({dashboard['render_ms_per_second']:.1f} ms per s at 30 fps), "
+                  f"stop {dashboard['stop_ms']:.1f} ms")
+        print(f"    max sustainable rate ~{entry['max_sustainable_rate']:,.0f} Hz")
+
+    with open(args.output, "w", encoding="utf-8") as f:
+        json.dump(report, f, indent=2)
+    print(f"Report written to {args.output}")
+
+    if args.baseline:
+        with open(args.baseline, "r", encoding="utf-8") as f:
+            baseline = json.load(f)
+        regressions = compare(report, baseline, args.tolerance)
+        for message in regressions:
+            print(f"  REGRESSION: {message}")
+        if regressions:
+            return 1
+        print(f"No regressions against {args.baseline}")
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -29,7 +29,6 @@ pip install PyQt6
 pip install pyserial
 pip install numpy
 pip install pyqtgraph
-pip install pandas
 
 echo.
 echo [2/3] Building executable...
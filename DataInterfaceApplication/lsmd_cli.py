@@ -0,0 +1,291 @@
+"""
+LSMD Command Line Interface - Headless acquisition and batch analysis
+Runs the same transport workers, decoder, calibration, filters and session files as the GUI,
+without any windows, for bench testing, overnight soak tests and reprocessing old sessions.
+
+Acquire timed trials from a device or a replayed recording, each trial saved as a session file:
+    python lsmd_cli.py acquire --usb COM3 --duration 5 --trials 10 --rest 2
+    python lsmd_cli.py acquire --ble AA:BB:CC:DD:EE:FF --duration 5
+    python lsmd_cli.py acquire --replay sessions/session_20250101_120000.lsmd --speed 0
+
+Compute peak torque, onset and RTD for every session in a folder, spread across CPU cores:
+    python lsmd_cli.py analyze sessions --lowpass 20 --summary results.csv
+
+Simulate a device on a pseudo-terminal (Linux/macOS), then connect the GUI or acquire to the printed port:
+    python lsmd_cli.py simulate --rate 5000 --format binary --drop-rate 0.001 --burst-interval 2
+
+Measure command round trip and sample-to-pipeline latency while acquiring (GUI: main.py --latency-probe),
+then compare runs per link and configuration:
+    python lsmd_cli.py acquire --usb COM3 --duration 10 --latency-probe 0.1
+    python lsmd_cli.py latency sessions/latency.jsonl
+"""
+
+import argparse
+import csv
+import glob
+import json
+import os
+import sys
+import time
+from concurrent.futures import ProcessPoolExecutor
+
+import numpy as np
+
+from utils.session_file import SessionReader, FILE_EXTENSION
+from utils.piecewise_linear_calibration import PiecewiseLinearCalibration
+from utils.notch_filter import NotchFilter
+from utils.butterworth_filter import ButterworthFilter
+from utils.moving_average_filter import MovingAverageFilter
+from utils import torque_analysis
+
+APP_DIR = os.path.dirname(os.path.abspath(__file__))
+CAL_FILE = os.path.join(APP_DIR, "calibration.json")
+SESSION_DIR = os.path.join(APP_DIR, "sessions")
+
+DEFAULT_LIMB_LENGTH_M = 0.50
+
+#Filters in GUI order (notch, butterworth, moving average) from command line options
+def build_filters(args, sample_rate):
+    filters = []
+    if args.notch:
+        filters.append(NotchFilter(sample_rate=sample_rate))
+    if args.lowpass:
+        filters.append(ButterworthFilter(cutoff=args.lowpass, sample_rate=sample_rate))
+    if args.moving_average:
+        filters.append(MovingAverageFilter(window_size=args.moving_average))
+    return filters
+
+#One line of trial results
+def format_result(result):
+    rtd = "  ".join(f"RTD{window * 1000:.0f} {rate:8.1f}" if rate is not None else f"RTD{window * 1000:.0f}        —"
+                    for window, rate in zip(torque_analysis.RTD_WINDOWS, result["rtd"]))
+    onset = f"{result['onset']:7.3f} s" if result["onset"] is not None else "      — "
+    return f"peak {result['peak']:8.2f} N·m  onset {onset}  {rtd}  N·m/s"
+
+#Peak, onset and RTD of one trial as plain values (picklable for worker processes)
+def trial_result(times, force, limb_length_m):
+    analysis = torque_analysis.analyze_trial(times, force * limb_length_m)
+    return {
+        "samples": len(times),
+        "duration": float(times[-1] - times[0]) if len(times) > 1 else 0.0,
+        "peak": analysis.peak_torque if analysis.peak_torque is not None else 0.0,
+        "onset": analysis.onset_time,
+        "rtd": [analysis.rtd_windows.get(window) for window in torque_analysis.RTD_WINDOWS],
+        "peak_slope": analysis.peak_slope,
+    }
+
+#Analyse one session file, runs in a worker process
+#Stored force is unfiltered, filters are applied zero-phase as the GUI does after a trial
+def analyze_session_file(path, limb_length_m, filter_options):
+    session = SessionReader(path)
+    force = np.asarray(session.samples["force"], dtype=np.float64)
+    for f in build_filters(filter_options, session.sample_rate):
+        force = np.asarray(f.apply(force), dtype=np.float64)
+
+    limb_length_m = limb_length_m or session.header.get("limb_length_m") or DEFAULT_LIMB_LENGTH_M
+    result = trial_result(session.times(), force, limb_length_m)
+    result["path"] = path
+    return result
+
+#Session files named on the command line, directories are searched recursively
+def find_sessions(paths):
+    found = []
+    for path in paths:
+        if os.path.isdir(path):
+            found.extend(glob.glob(os.path.join(path, "**", "*" + FILE_EXTENSION), recursive=True))
+        else:
+            found.append(path)
+    return sorted(found)
+
+#Filter options only, argparse namespaces carry more than worker processes need
+class FilterOptions:
+    def __init__(self, args):
+        self.notch = args.notch
+        self.lowpass = args.lowpass
+        self.moving_average = args.moving_average
+
+#analyze command
+def run_analyze(args):
+    paths = find_sessions(args.paths)
+    if not paths:
+        print("No session files found")
+        return 1
+
+    options = FilterOptions(args)
+    start = time.perf_counter()
+    results = []
+    with ProcessPoolExecutor(max_workers=args.workers) as pool:
+        futures = [pool.submit(analyze_session_file, path, args.limb_length, options) for path in paths]
+        for path, future in zip(paths, futures):
+            #Any failure in one file (bad header, truncated data, crashed worker) is reported and skipped
+            try:
+                result = future.result()
+            except (OSError, ValueError) as e:
+                print(f"{os.path.basename(path)}: {str(e)}")
+                continue
+            except Exception as e:
+                print(f"{os.path.basename(path)}: {type(e).__name__}: {str(e)}")
+                continue
+            results.append(result)
+            print(f"{os.path.basename(path)}: {format_result(result)}")
+    elapsed = time.perf_counter() - start
+
+    total_samples = sum(result["samples"] for result in results)
+    print(f"Analysed {len(results)}/{len(paths)} sessions, {total_samples} samples in {elapsed:.2f} s "
+          f"({total_samples / elapsed:,.0f} samples/s)")
+
+    if args.summary:
+        write_summary(args.summary, results)
+        print(f"Summary written to {args.summary}")
+    return 0 if len(results) == len(paths) else 1
+
+#Summary table of analysed sessions, one row per file
+def write_summary(path, results):
+    windows = [f"RTD 0-{window * 1000:.0f} ms (N·m/s)" for window in torque_analysis.RTD_WINDOWS]
+    with open(path, "w", encoding="utf-8-sig", newline="") as f:
+        writer = csv.writer(f)
+        writer.writerow(["File", "Samples", "Duration (s)", "Peak Torque (N·m)", "Onset (s)"] + windows + ["Peak Slope (N·m/s)"])
+        for result in results:
+            writer.writerow([os.path.basename(result["path"]), result["samples"], f"{result['duration']:.3f}",
+                             f"{result['peak']:.2f}", _optional(result["onset"], "%.3f")]
+                            + [_optional(rate, "%.2f") for rate in result["rtd"]]
+                            + [_optional(result["peak_slope"], "%.2f")])
+
+#Formatted value or empty cell
+def _optional(value, fmt):
+    return fmt % value if value is not None else ""
+
+#acquire command
+def run_acquire(args):
+    #Qt and the transport workers are only needed to acquire
+    from PyQt6.QtCore import QCoreApplication, QTimer
+    from utils.headless_acquisition import HeadlessAcquisition
+
+    app = QCoreApplication(sys.argv[:1])
+
+    calibration = PiecewiseLinearCalibration()
+    if calibration.load_from_file(args.calibration):
+        print(f"Calibration loaded — {len(calibration.lookup_table)} points")
+    else:
+        calibration = None
+        print("No calibration — raw ADC values are stored as force")
+
+    acquisition = HeadlessAcquisition(args, calibration, build_filters(args, args.sample_rate))
+    acquisition.finished.connect(app.quit)
+    QTimer.singleShot(0, acquisition.begin)
+    app.exec()
+    return acquisition.exit_code
+
+#simulate command, runs until interrupted
+def run_simulate(args):
+    from utils.device_simulator import DeviceSimulator, session_trace
+
+    trace = session_trace(args.trace) if args.trace else None
+    simulator = DeviceSimulator(sample_rate=args.rate, frame_format=args.format, trace=trace,
+                                drop_rate=args.drop_rate, garbage_rate=args.garbage_rate,
+                                burst_interval=args.burst_interval, burst_hold=args.burst_hold)
+    port_name = simulator.open()
+    print(f"Simulated device on {port_name} ({args.rate} samples/s, {args.format}), Ctrl+C to stop")
+
+    last_bytes = 0
+    try:
+        while True:
+            time.sleep(1.0)
+            rate = simulator.bytes_written - last_bytes
+            last_bytes = simulator.bytes_written
+            state = "streaming" if simulator.streaming else "idle"
+            print(f"{state}: {simulator.samples_generated} samples, {simulator.samples_dropped} dropped, "
+                  f"{rate:,} bytes/s, {simulator.bytes_lost} bytes lost to overflow")
+    except KeyboardInterrupt:
+        pass
+    simulator.close()
+    return 0
+
+#latency command, percentiles of logged probe results grouped by link and configuration
+def run_latency(args):
+    from utils.latency_probe import MEASURES, summarize, format_summary
+
+    groups = {}
+    for path in args.paths:
+        try:
+            with open(path, "r", encoding="utf-8") as f:
+                records = [json.loads(line) for line in f if line.strip()]
+        except (OSError, ValueError) as e:
+            print(f"{path}: {str(e)}")
+            return 1
+        for record in records:
+            key = (record["link"], json.dumps(record["config"], sort_keys=True))
+            group = groups.setdefault(key, {"trials": 0, **{measure: [] for measure in MEASURES}})
+            group["trials"] += 1
+            for measure in MEASURES:
+                group[measure].extend(record.get(measure, []))
+
+    if not groups:
+        print("No latency results found")
+        return 1
+    for (link, config), group in sorted(groups.items()):
+        print(f"{link}  {config}  ({group['trials']} trials)")
+        #Logged values are ms, summarize takes seconds
+        print(format_summary({measure: summarize(np.asarray(group[measure]) / 1000.0) for measure in MEASURES}))
+    return 0
+
+#Filter options shared by both commands
+def add_filter_arguments(parser):
+    parser.add_argument("--notch", action="store_true", help="50/60 Hz notch filter")
+    parser.add_argument("--lowpass", type=float, metavar="HZ", help="Butterworth low-pass cutoff")
+    parser.add_argument("--moving-average", type=int, metavar="N", help="moving average window in samples")
+    parser.add_argument("--limb-length", type=float, metavar="M", help="limb length in metres (default: from session, else 0.5)")
+
+def main():
+    parser = argparse.ArgumentParser(description="LSMD headless acquisition and batch analysis")
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    acquire = commands.add_parser("acquire", help="run timed trials and save session files")
+    source = acquire.add_mutually_exclusive_group(required=True)
+    source.add_argument("--usb", metavar="PORT", help="serial port, e.g. COM3 or /dev/ttyUSB0")
+    source.add_argument("--ble", metavar="ADDRESS", help="Bluetooth device address")
+    source.add_argument("--replay", metavar="FILE", help="session file or raw stream capture")
+    acquire.add_argument("--baud", type=int, default=115200, help="USB baud rate")
+    acquire.add_argument("--speed", type=float, default=1.0, help="replay speed, 0 = as fast as possible")
+    acquire.add_argument("--duration", type=float, default=5.0, help="seconds per trial")
+    acquire.add_argument("--trials", type=int, default=1, help="number of trials")
+    acquire.add_argument("--rest", type=float, default=1.0, help="seconds between trials")
+    acquire.add_argument("--output", default=SESSION_DIR, help="folder for session files")
+    acquire.add_argument("--calibration", default=CAL_FILE, help="calibration file")
+    acquire.add_argument("--zero-offset", type=float, default=0.0, help="zero offset in N")
+    acquire.add_argument("--sample-rate", type=int, default=1200, help="device sample rate in Hz")
+    acquire.add_argument("--format", choices=("ascii", "binary"), default="ascii",
+                         help="stream format, binary frames carry sequence numbers for exact loss detection")
+    acquire.add_argument("--latency-probe", type=float, metavar="SECONDS",
+                         help="ping the device at this interval and log latency to OUTPUT/latency.jsonl")
+    add_filter_arguments(acquire)
+
+    analyze = commands.add_parser("analyze", help="peak torque and RTD of recorded sessions")
+    analyze.add_argument("paths", nargs="+", help="session files or folders")
+    analyze.add_argument("--workers", type=int, default=None, help="worker processes (default: CPU count)")
+    analyze.add_argument("--summary", metavar="CSV", help="write results table to CSV")
+    add_filter_arguments(analyze)
+
+    simulate = commands.add_parser("simulate", help="simulated device on a pseudo-terminal")
+    simulate.add_argument("--rate", type=int, default=1200, help="samples per second")
+    simulate.add_argument("--format", choices=("ascii", "binary"), default="ascii", help="stream format")
+    simulate.add_argument("--trace", metavar="FILE", help="session file to replay ADC values from (default: synthetic)")
+    simulate.add_argument("--drop-rate", type=float, default=0.0, help="fraction of samples dropped")
+    simulate.add_argument("--garbage-rate", type=float, default=0.0, help="garbage insertions per second")
+    simulate.add_argument("--burst-interval", type=float, default=0.0, help="seconds between output stalls, 0 = off")
+    simulate.add_argument("--burst-hold", type=float, default=0.2, help="seconds each stall holds output")
+
+    latency = commands.add_parser("latency", help="compare logged latency probe results")
+    latency.add_argument("paths", nargs="+", help="latency.jsonl files")
+
+    args = parser.parse_args()
+    if args.command == "acquire":
+        return run_acquire(args)
+    if args.command == "simulate":
+        return run_simulate(args)
+    if args.command == "latency":
+        return run_latency(args)
+    return run_analyze(args)
+
+if __name__ == "__main__":
+    sys.exit(main())
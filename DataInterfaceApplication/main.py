@@ -1,15 +1,22 @@
 """
 LSMD Data Interface - Main Application
 Run this file to start the program
+
+Options:
+    --latency-probe SECONDS   ping the device at this interval while acquiring and log command round trip
+                              and sample-to-display latency to sessions/latency.jsonl
+    --devices SPEC [SPEC ...] acquire several devices at once on one aligned timeline, e.g.
+                              --devices usb:COM3 usb:COM4   or   --devices ble:AA:BB:CC:DD:EE:FF replay:left.lsmd
 """
 
+import argparse
 import sys
 import json
 import os
 
-from PyQt6.QtWidgets import QApplication
+from PyQt6.QtWidgets import QApplication, QFileDialog, QInputDialog
 from PyQt6.QtGui import (QFont, QPalette, QColor)
-from PyQt6.QtCore import QTimer, QEvent, QObject
+from PyQt6.QtCore import Qt, QTimer, QEvent, QObject, pyqtSignal
 
 from windows.connection_window import ConnectionWindow
 from windows.device_selection import DeviceSelection
@@ -17,10 +24,13 @@ from windows.data_acquisition import DataAcquisitionWindow
 from windows.data_acquisition_dashboard import DataAcquisitionDashboard
 from windows.calibration_window import CalibrationWindow
 from windows.settings_window import SettingsWindow
+from windows.multi_device_dashboard import MultiDeviceDashboard
 from utils.bluetooth_manager import BluetoothWorker
 from utils.usb_manager import USBWorker
+from utils.replay_worker import ReplayWorker
 from utils.zero_calibration import ZeroCalibration
 from utils.piecewise_linear_calibration import PiecewiseLinearCalibration
+from utils.multi_device_acquisition import parse_device_spec
 
 #Path to calibration file, resolves to exe directory if frozen, otherwise current file directory
 def get_app_dir():
@@ -31,13 +41,22 @@ def get_app_dir():
 
 APP_DIR = get_app_dir()
 CAL_FILE = os.path.join(APP_DIR, "calibration.json")
+SESSION_DIR = os.path.join(APP_DIR, "sessions")
 
 #Main Application Controller
 class LSMDApplication(QObject):
-    def __init__(self):
+
+    #Define signals
+    gui_data_received = pyqtSignal(bytes)   #transport data that must be handled on the GUI thread
+
+    #latency_probe: ping interval in seconds for latency probe mode, None = off
+    #devices: device specs for multi-device acquisition, None = single device through the connection window
+    def __init__(self, latency_probe=None, devices=None):
         super().__init__()
         self.app = QApplication(sys.argv)
         self.setup_application()
+        self.latency_probe_interval = latency_probe
+        self.multi_device_window = None
 
         #Reference to window
         self.connection_window = None
@@ -59,6 +78,10 @@ class LSMDApplication(QObject):
         self.connected_port = None
         self.connected_baud_rate = None
 
+        #Replay worker, plays a recorded trial through the live pipeline
+        self.replay_worker = None
+        self.replay_path = None
+
         #Zero calibration for force measurements
         self.zero_calibration = ZeroCalibration()
 
@@ -79,8 +102,14 @@ class LSMDApplication(QObject):
         #Track connection type
         self.connection_type = None
 
-        #Show connection window
-        self.show_connection_window()
+        #Transport data not taken by the pipeline worker is handled on the GUI thread
+        self.gui_data_received.connect(self.on_data_received)
+
+        #Show multi-device window when devices were given, connection window otherwise
+        if devices:
+            self.show_multi_device_window(devices)
+        else:
+            self.show_connection_window()
     
     #Application settings
     def setup_application(self):
@@ -108,9 +137,52 @@ class LSMDApplication(QObject):
 
         self.connection_window.usb_selected.connect(self.on_usb_connection)
         self.connection_window.bluetooth_selected.connect(self.on_bluetooth_connection)
+        self.connection_window.replay_selected.connect(self.on_replay_connection)
+        self.connection_window.multi_device_selected.connect(self.on_multi_device_connection)
         
         self.connection_window.show()
     
+    #Multi-device screen, every device connects on its own
+    def show_multi_device_window(self, devices):
+        calibration = self.piecewise_calibration if self.piecewise_calibration.is_calibrated else None
+        self.multi_device_window = MultiDeviceDashboard(devices, calibration=calibration, session_dir=SESSION_DIR,
+                                                        limb_length_m=self.get_limb_length_m())
+        self.multi_device_window.disconnect_request.connect(self.on_multi_device_disconnect)
+        self.multi_device_window.show()
+
+    #Multiple devices selected, device specs entered as on the command line (--devices)
+    def on_multi_device_connection(self):
+        text, ok = QInputDialog.getText(self.connection_window, "Multiple Devices",
+                                        "Devices, separated by spaces (usb:PORT[@BAUD], ble:ADDRESS, replay:FILE):")
+        specs = text.split()
+        if not ok or not specs:
+            return
+        try:
+            for spec in specs:
+                parse_device_spec(spec)
+        except ValueError as e:
+            print(str(e))
+            return
+
+        #Disconnect returns to a new connection window
+        self.connection_window.close()
+        self.show_multi_device_window(specs)
+
+    #Limb length from the settings window in m, 0.5 m default before settings were opened
+    def get_limb_length_m(self):
+        if self.settings_window is None:
+            return 0.50
+        try:
+            return float(self.settings_window.limb_length_input.text().strip()) / 100.0
+        except ValueError:
+            return 0.50
+
+    #Close multi-device screen, its close event stops all devices
+    def on_multi_device_disconnect(self):
+        self.multi_device_window.close()
+        self.multi_device_window = None
+        self.show_connection_window()
+
     #USB connection
     def on_usb_connection(self):
         print("USB selected")
@@ -165,15 +237,15 @@ class LSMDApplication(QObject):
 
         #Check and create Bluetooth worker
         if self.bluetooth_worker is None:
-            self.bluetooth_worker = BluetoothWorker()
+            self.bluetooth_worker = BluetoothWorker.shared()
 
             #Connect worker to handler
             self.bluetooth_worker.connected.connect(self.on_bluetooth_connected)
             self.bluetooth_worker.disconnected.connect(self.on_bluetooth_disconnected)
             self.bluetooth_worker.error.connect(self.on_bluetooth_error)
 
-            #Connect data received
-            self.bluetooth_worker.manager.data_received.connect(self.on_data_received)
+            #Connect data received, runs on the transport thread
+            self.bluetooth_worker.manager.data_received.connect(self.on_transport_data, Qt.ConnectionType.DirectConnection)
 
         #Connection
         self.bluetooth_worker.connect(device_address)
@@ -202,6 +274,8 @@ class LSMDApplication(QObject):
             #Create based on connection type
             if self.connection_type == "bluetooth":
                 self.data_acquisition_window = DataAcquisitionDashboard(connection_type="bluetooth", device_address=self.connected_device_address)
+            elif self.connection_type == "replay":
+                self.data_acquisition_window = DataAcquisitionDashboard(connection_type="replay", port_name=self.replay_path)
             else:
                 self.data_acquisition_window = DataAcquisitionDashboard(connection_type="usb", port_name=self.connected_port, baud_rate=self.connected_baud_rate)
 
@@ -210,6 +284,16 @@ class LSMDApplication(QObject):
             self.data_acquisition_window.navigate_to_settings.connect(self.on_navigate_to_settings)
             self.data_acquisition_window.clear_data_selected.connect(self.on_clear_data_filters)
 
+            #Replay sources carry their own sample rate (read when the source opened)
+            if self.connection_type == "replay":
+                self.data_acquisition_window.set_sample_rate(self.replay_worker.sample_rate, device=True)
+
+            #Each trial is recorded to a session file as it is acquired
+            self.data_acquisition_window.session_dir = SESSION_DIR
+            if self.latency_probe_interval:
+                self.data_acquisition_window.enable_latency_probe(self.latency_probe_interval,
+                                                                  os.path.join(SESSION_DIR, "latency.jsonl"))
+
             #Pass settings for limb length access
             if self.settings_window:
                 self.data_acquisition_window.settings_window = self.settings_window
@@ -219,6 +303,8 @@ class LSMDApplication(QObject):
             #Create based on connection type
             if self.connection_type == "bluetooth":
                 self.data_acquisition_window = DataAcquisitionWindow(connection_type="bluetooth", device_address=self.connected_device_address)
+            elif self.connection_type == "replay":
+                self.data_acquisition_window = DataAcquisitionWindow(connection_type="replay", port_name=self.replay_path)
             else:
                 self.data_acquisition_window = DataAcquisitionWindow(connection_type="usb", port_name=self.connected_port, baud_rate=self.connected_baud_rate)
 
@@ -248,6 +334,8 @@ class LSMDApplication(QObject):
         if self.settings_window is None:
             if self.connection_type == "bluetooth":
                 self.settings_window = SettingsWindow(connection_type="bluetooth", device_address=self.connected_device_address)
+            elif self.connection_type == "replay":
+                self.settings_window = SettingsWindow(connection_type="replay", port_name=self.replay_path)
             else:
                 self.settings_window = SettingsWindow(connection_type="usb", port_name=self.connected_port, baud_rate=self.connected_baud_rate)
         
@@ -358,6 +446,18 @@ class LSMDApplication(QObject):
             self.data_acquisition_window.setGeometry(self._saved_geometry)
             self.data_acquisition_window.show()
 
+    #Transport data received
+    #Runs on the transport thread, acquisition data goes straight into the dashboard pipeline queue
+    #everything else (calibration, debug view, stray replies) is passed to the GUI thread
+    def on_transport_data(self, data):
+        window = self.data_acquisition_window
+        calibrating = self.calibration_window and (self.calibration_window.is_zero_collecting or
+                                                   self.calibration_window.is_five_point_collecting)
+        if not calibrating and isinstance(window, DataAcquisitionDashboard) and window.is_acquiring:
+            window.append_data(data)
+        else:
+            self.gui_data_received.emit(data)
+
     #Data received
     def on_data_received(self, data):
         #Route to calibration window if zero calibration is collecting
@@ -381,6 +481,8 @@ class LSMDApplication(QObject):
             self.bluetooth_worker.send(data)
         elif self.connection_type == "usb" and self.usb_worker:
             self.usb_worker.manager.send_data(data)
+        elif self.connection_type == "replay" and self.replay_worker:
+            self.replay_worker.send(data)
     
     #User selects disconnect
     def on_disconnect_request(self):
@@ -395,6 +497,9 @@ class LSMDApplication(QObject):
             self.bluetooth_worker.disconnect_device()
         elif self.connection_type == "usb" and self.usb_worker:
             self.usb_worker.disconnect()
+        elif self.connection_type == "replay" and self.replay_worker:
+            self.replay_worker.disconnect()
+            self.replay_worker = None
         
         #close data acquisition window
         if self.data_acquisition_window:
@@ -431,7 +536,9 @@ class LSMDApplication(QObject):
 
     #Event loop
     def run(self):
-        return self.app.exec()
+        result = self.app.exec()
+        BluetoothWorker.shutdown_shared()    #stop BLE event loop thread if it was used
+        return result
 
     #User selects USB device
     def on_usb_device_selected(self, port_name, baud_rate):
@@ -449,8 +556,8 @@ class LSMDApplication(QObject):
             self.usb_worker.disconnected.connect(self.on_usb_disconnected)
             self.usb_worker.error.connect(self.on_usb_error)
 
-            #Connect data recieved
-            self.usb_worker.data_received.connect(self.on_data_received)
+            #Connect data recieved, runs on the transport thread
+            self.usb_worker.data_received.connect(self.on_transport_data, Qt.ConnectionType.DirectConnection)
         
         #Connection
         self.usb_worker.manager.set_baud_rate(baud_rate)
@@ -470,6 +577,65 @@ class LSMDApplication(QObject):
             #Reset connection
             self.connection_window.update_connection_status(None)
 
+    #Replay selected, choose recording and playback speed
+    def on_replay_connection(self):
+        print("Replay selected")
+
+        file_path, _ = QFileDialog.getOpenFileName(
+            self.connection_window,
+            "Replay Recording",
+            SESSION_DIR if os.path.isdir(SESSION_DIR) else APP_DIR,
+            "Recordings (*.lsmd *.csv);;Raw Stream Captures (*)"
+        )
+        if not file_path:
+            self.connection_window.update_connection_status(None)
+            return
+
+        speeds = {"1× (real time)": 1.0, "2×": 2.0, "5×": 5.0, "10×": 10.0, "Max": 0.0}
+        speed_text, ok = QInputDialog.getItem(self.connection_window, "Replay Speed", "Playback speed:",
+                                              list(speeds), 0, False)
+        if not ok:
+            self.connection_window.update_connection_status(None)
+            return
+
+        self.replay_path = file_path
+        self.connection_type = "replay"
+
+        #CSV exports hold torque, converted back to ADC values with the current calibration
+        #and the limb length stored in the export (default limb length for older exports)
+        calibration = self.piecewise_calibration if self.piecewise_calibration.is_calibrated else None
+        self.replay_worker = ReplayWorker(file_path, speed=speeds[speed_text], calibration=calibration,
+                                          zero_offset=self.zero_calibration.zero_offset)
+        self.replay_worker.connected.connect(self.on_replay_connected)
+        self.replay_worker.error.connect(self.on_replay_error)
+        self.replay_worker.finished_source.connect(self.on_replay_finished)
+
+        #Connect data received, runs on the replay thread
+        self.replay_worker.data_received.connect(self.on_transport_data, Qt.ConnectionType.DirectConnection)
+        self.replay_worker.connect()
+
+    #Replay source opened
+    def on_replay_connected(self, success):
+        if success:
+            print(f"Replaying {self.replay_path}")
+            self.connection_window.hide()
+            self._saved_geometry = self.connection_window.geometry() #Save size
+            self.show_data_acquisition_window()
+        else:
+            print("Failed to open replay source")
+            self.replay_worker = None
+            self.connection_window.update_connection_status(None)
+
+    #End of recording, stop the trial so the pipeline report covers the whole replay
+    def on_replay_finished(self):
+        window = self.data_acquisition_window
+        if isinstance(window, DataAcquisitionDashboard) and window.is_acquiring:
+            window.on_stop_clicked()
+
+    #Replay error
+    def on_replay_error(self, error_message):
+        print(f"Replay error: {error_message}")
+
     #USB disconnects
     def on_usb_disconnected(self):
         print(f"USB device disconnected")
@@ -575,7 +741,11 @@ class LSMDApplication(QObject):
     
 #Main app
 def main():
-    app = LSMDApplication()
+    parser = argparse.ArgumentParser(description="LSMD Data Interface")
+    parser.add_argument("--latency-probe", type=float, metavar="SECONDS", help="ping interval for latency probe mode")
+    parser.add_argument("--devices", nargs="+", metavar="SPEC", help="usb:PORT[@BAUD], ble:ADDRESS or replay:FILE per device")
+    args, _ = parser.parse_known_args()    #Qt options pass through to QApplication
+    app = LSMDApplication(latency_probe=args.latency_probe, devices=args.devices)
     sys.exit(app.run())
 
 if __name__ == "__main__":
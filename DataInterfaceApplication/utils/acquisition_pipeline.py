@@ -0,0 +1,409 @@
+"""
+Acquisition Pipeline - Sample processing off the GUI thread
+Transport bytes go into a bounded queue, a worker thread decodes, calibrates, zero corrects,
+filters and stores them, and the GUI pulls a ready-to-plot snapshot at its own frame rate.
+Dialogs, resizing or slow frames on the GUI thread no longer hold up the data path.
+Sample times come from the true sample index reported by the decoder, so samples lost on the link
+leave a gap in the time axis (recorded in gaps) instead of compressing it.
+Chunk arrival times also feed a clock aligner, which maps sample times onto the host clock when
+several devices are acquired together.
+
+AcquisitionPipeline - processing state (decoder, sample store, envelope, running stats), guarded by lock
+PipelineWorker      - QThread that feeds queued chunks through the pipeline
+"""
+
+import queue
+import threading
+import time
+import numpy as np
+from PyQt6.QtCore import QThread, pyqtSignal
+from utils.stream_decoder import StreamDecoder
+from utils.sample_store import SampleStore
+from utils.envelope_pyramid import EnvelopePyramid
+from utils.pipeline_stats import PipelineStats
+from utils.stream_monitor import StreamMonitor
+from utils.clock_aligner import ClockAligner
+
+TRANSIENT_SAMPLES = 25      #discarded at start of each trial, BLE connection transient
+
+#What the GUI needs to draw one frame, copied out under the pipeline lock
+class PlotSnapshot:
+    def __init__(self, line_x, line_y, sample_count, last_time, torque_min, torque_max):
+        self.line_x = line_x
+        self.line_y = line_y
+        self.sample_count = sample_count
+        self.last_time = last_time
+        self.torque_min = torque_min
+        self.torque_max = torque_max
+
+class AcquisitionPipeline:
+    #Initialize with capacity in samples and sample rate in Hz
+    #growable keeps every sample of a trial instead of only the newest capacity samples
+    def __init__(self, capacity, sample_rate, growable=False):
+        self.sample_rate = sample_rate
+
+        #Columns: time, force (filtered for display), raw_force (unfiltered) and torque (force * limb length)
+        self.samples = SampleStore(capacity, columns=("time", "force", "raw_force", "torque"), growable=growable)
+        self.torque_envelope = EnvelopePyramid()    #min/max levels of torque column for drawing long captures
+        self.stream_decoder = StreamDecoder()       #keeps incomplete lines between chunks
+
+        #Held by the worker while it changes stored data and by the GUI while it reads it
+        self.lock = threading.RLock()
+
+        #Set from the GUI thread
+        self.piecewise_cal = None
+        self.zero_offset = 0.0
+        self.limb_length_m = 0.50
+        self.filters = []           #run causally on each block while acquiring
+        self.session_writer = None  #records every stored sample to disk while set
+
+        #Running stats, updated per block instead of rescanning history
+        self.sample_count = 0
+        self.torque_min = None
+        self.torque_max = None
+        self._torque_limb_m = None  #limb length the torque column was computed with
+        self._transient_count = 0
+
+        #Sample loss: (time of first missing sample in s, samples missing) per gap, from sequence numbers
+        self.gaps = []
+        self.samples_lost = 0
+        self._index_origin = None   #decoder index of the first stored sample, time zero
+        self._last_index = None     #index of the last stored sample relative to the origin
+        self.last_stream_index = -1 #decoder index of the last stored sample
+
+        #Set while a latency probe runs, told about pongs and stored samples
+        self.latency_probe = None
+
+        #Throughput and time spent per stage, chunk arrival statistics
+        self.stats = PipelineStats()
+        self.monitor = StreamMonitor(sample_rate)
+        self.clock = ClockAligner()
+
+    #Replace the store with an empty one of capacity samples, growable keeps every sample of the trial
+    def set_store(self, capacity, growable):
+        with self.lock:
+            self.samples = SampleStore(capacity, columns=self.samples.columns, growable=growable)
+            self.reset()
+
+    #Clear stored data and stream state for a new trial
+    def reset(self):
+        with self.lock:
+            self.samples.clear()
+            self.stream_decoder.reset()
+            self.sample_count = 0
+            self._transient_count = 0
+            self._reset_torque_range()
+            self.gaps = []
+            self.samples_lost = 0
+            self._index_origin = None
+            self._last_index = None
+            self.last_stream_index = -1
+            self.stats.reset()
+            self.monitor.sample_rate = self.sample_rate
+            self.monitor.reset()
+            self.clock.reset()
+            for f in self.filters:
+                f.reset_stream()
+
+    #Decode a chunk of transport bytes and store the samples, returns number stored
+    #arrivals: perf_counter times the chunks making up data were received, for the stream monitor
+    def process(self, data, arrivals=None):
+        stats = self.stats
+        stage_start = time.perf_counter()
+
+        #Decoder state is cleared by reset() from the GUI thread, so decode under the same lock
+        with self.lock:
+            adc_values = self.stream_decoder.decode(data)
+            indices = self.stream_decoder.indices
+            pongs = self.stream_decoder.pongs
+            if arrivals:
+                next_index = self._last_index + 1 if self._last_index is not None else 0
+                self.monitor.record(arrivals, len(adc_values), next_index / self.sample_rate)
+
+            #Discard first samples to remove BLE connection transient
+            if self._transient_count < TRANSIENT_SAMPLES:
+                skip = min(TRANSIENT_SAMPLES - self._transient_count, len(adc_values))
+                self._transient_count += skip
+                adc_values = adc_values[skip:]
+                indices = indices[skip:]
+
+        probe = self.latency_probe
+        if probe is not None and pongs:
+            arrival = arrivals[-1] if arrivals else time.perf_counter()
+            for token, index in pongs:
+                probe.on_pong(token, index, arrival)
+        if len(adc_values) == 0:
+            return 0
+
+        decoded = time.perf_counter()
+        stats.record("decode", decoded - stage_start)
+
+        #Apply piecewise calibration if available, otherwise pass raw ADC value
+        calibration = self.piecewise_cal
+        if calibration and calibration.is_calibrated:
+            corrected_values = calibration.adc_to_newtons_array(adc_values) - self.zero_offset
+        else:
+            corrected_values = adc_values - self.zero_offset
+        calibrated = time.perf_counter()
+        stats.record("calibrate", calibrated - decoded)
+
+        with self.lock:
+            #Calculate time from the true sample index, lost samples leave a gap
+            if self._index_origin is None:
+                self._index_origin = int(indices[0])
+            sample_indices = indices - self._index_origin
+            self._record_gaps(sample_indices, self.sample_rate)
+            time_values = sample_indices / self.sample_rate
+
+            #Live filtering, each filter carries its state over from the previous block
+            stage_start = time.perf_counter()
+            force_values = corrected_values
+            for f in self.filters:
+                force_values = f.process_block(force_values)
+            filtered = time.perf_counter()
+            stats.record("filter", filtered - stage_start)
+
+            #Keep torque column and running range in sync as blocks arrive
+            if self._torque_limb_m is None:
+                self._torque_limb_m = self.limb_length_m
+            torque_values = force_values * self._torque_limb_m
+            self.torque_envelope.append(torque_values)
+
+            first_index = self.samples.first_index
+            self.samples.append(time=time_values, force=force_values, raw_force=corrected_values, torque=torque_values)
+            if self.samples.first_index == first_index:
+                self._extend_torque_range(torque_values)
+            else:
+                #Oldest rows dropped, the range and envelope must only cover what is still stored (plotted and exported)
+                self._reset_range_to_stored()
+                self.torque_envelope.trim(self.samples.first_index)
+            self.sample_count += len(adc_values)
+            self.last_stream_index = int(indices[-1])
+            stats.record("store", time.perf_counter() - filtered)
+
+            #Read while locked, reset() clears them from the GUI thread
+            stream_index = self.last_stream_index
+            stream_time = self._last_index / self.sample_rate
+
+            #Writer taken with the samples it must record, closing it after take_session_writer waits for its lock
+            writer = self.session_writer
+            if writer is not None:
+                writer.lock.acquire()
+        if probe is not None:
+            probe.on_stored(stream_index)
+        if arrivals:
+            self.clock.record(arrivals[-1], stream_time)
+
+        #Disk write outside the pipeline lock, GUI never waits on file I/O
+        if writer is not None:
+            try:
+                stage_start = time.perf_counter()
+                writer.append(sample_indices, adc_values, corrected_values)
+                stats.record("session", time.perf_counter() - stage_start)
+            finally:
+                writer.lock.release()
+        stats.add_batch(len(adc_values))
+        return len(adc_values)
+
+    #Stop recording, returns the session writer (None if not recording) once no batch is writing to it
+    #Caller closes it, close waits for a batch that stored samples before the writer was taken
+    def take_session_writer(self):
+        with self.lock:
+            writer = self.session_writer
+            self.session_writer = None
+        return writer
+
+    #Replace stored data with a recorded session for review, active filters are applied zero-phase
+    def load_session(self, session):
+        count = len(session)
+        with self.lock:
+            #Store grows to hold the whole session, fixed capacity only limits live acquisition
+            if count > self.samples.capacity:
+                self.samples = SampleStore(count, columns=self.samples.columns, growable=self.samples.growable)
+            self.reset()
+            if count == 0:
+                return
+
+            raw = np.asarray(session.samples["force"], dtype=np.float64)
+            self.samples.append(time=session.times(), force=raw, raw_force=raw, torque=raw)
+            self.sample_count = count
+            self._record_gaps(session.samples["index"].astype(np.int64), session.sample_rate)
+            self.set_filters(self.filters, causal=False)
+
+    #Replace active filters and re-filter stored raw data
+    #causal=True primes the filters over the history so they continue block by block, otherwise zero-phase
+    def set_filters(self, filter_list, causal):
+        with self.lock:
+            self.filters = list(filter_list)
+            for f in self.filters:
+                f.reset_stream()
+            if len(self.samples) == 0:
+                return
+
+            # Start from raw data
+            filtered = self.samples.view("raw_force").copy()
+
+            # Apply each filter in order (notch, butterworth, moving average)
+            for f in self.filters:
+                filtered = f.process_block(filtered) if causal else f.apply(filtered)
+
+            self.samples.set_column("force", filtered)
+            self._rebuild_torque()
+
+    #Set limb length, torque is recomputed only if it changed
+    def set_limb_length(self, limb_length_m):
+        with self.lock:
+            self.limb_length_m = limb_length_m
+            if len(self.samples) > 0 and limb_length_m != self._torque_limb_m:
+                self._rebuild_torque()
+
+    #Visible part of the torque trace for time range [view_start, view_end], at most ~max_points points
+    def snapshot(self, view_start, view_end, max_points):
+        with self.lock:
+            if len(self.samples) == 0:
+                return PlotSnapshot(np.empty(0), np.empty(0), self.sample_count, 0.0, None, None)
+            time_data = self.samples.view("time")
+            torque_data = self.samples.view("torque")
+
+            start = max(0, int(np.searchsorted(time_data, view_start, side="right")) - 1)
+            stop = int(np.searchsorted(time_data, view_end, side="left")) + 1
+            indices, values = self.torque_envelope.render(torque_data, start, stop, max_points, self.samples.first_index)
+
+            #Copies, the store keeps changing after the lock is released
+            return PlotSnapshot(time_data[indices.astype(np.intp)], np.array(values), self.sample_count,
+                                float(time_data[-1]), self.torque_min, self.torque_max)
+
+    #Gaps recorded after the first count, copied
+    def gaps_since(self, count):
+        with self.lock:
+            return self.gaps[count:]
+
+    #Record holes in a block of sample indices (relative to the origin) that follows the stored ones
+    def _record_gaps(self, sample_indices, sample_rate):
+        previous = self._last_index if self._last_index is not None else sample_indices[0] - 1
+        steps = np.diff(sample_indices, prepend=previous)
+        for position in np.flatnonzero(steps > 1):
+            missing = int(steps[position]) - 1
+            self.gaps.append(((int(sample_indices[position]) - missing) / sample_rate, missing))
+            self.samples_lost += missing
+        self._last_index = int(sample_indices[-1])
+
+    #Recompute torque column and running range from stored force (filter or limb length change)
+    def _rebuild_torque(self):
+        self._torque_limb_m = self.limb_length_m
+        self._reset_torque_range()
+        if len(self.samples) == 0:
+            return
+        torque = self.samples.view("force") * self._torque_limb_m
+        self.samples.set_column("torque", torque)
+        self._extend_torque_range(torque)
+        self.torque_envelope.rebuild(torque, self.samples.first_index)
+
+    #Running min/max from the stored torque column
+    def _reset_range_to_stored(self):
+        torque = self.samples.view("torque")
+        if len(torque) == 0:
+            self.torque_min = self.torque_max = None
+            return
+        self.torque_min = float(torque.min())
+        self.torque_max = float(torque.max())
+
+    #Fold a block of torque values into the running min/max
+    def _extend_torque_range(self, torque_values):
+        if len(torque_values) == 0:
+            return
+        block_min = float(torque_values.min())
+        block_max = float(torque_values.max())
+        if self.torque_max is None:
+            self.torque_min, self.torque_max = block_min, block_max
+        else:
+            self.torque_min = min(self.torque_min, block_min)
+            self.torque_max = max(self.torque_max, block_max)
+
+    #Forget running torque range and envelope
+    def _reset_torque_range(self):
+        self.torque_min = None
+        self.torque_max = None
+        self.torque_envelope.clear()
+
+#Worker thread
+#Runs the pipeline separate from GUI, transport threads submit() straight into its queue
+class PipelineWorker(QThread):
+    #Define signals
+    error = pyqtSignal(str)     #when processing fails
+
+    #Initialize with pipeline, callback run after new samples are stored and max queued chunks
+    def __init__(self, pipeline, on_processed=None, max_chunks=1024):
+        super().__init__()
+        self.pipeline = pipeline
+        self.on_processed = on_processed
+        self.chunks = queue.Queue(maxsize=max_chunks)
+        self.running = False
+
+        #Chunks lost because the queue stayed full, reported once each time the queue overflows
+        self.chunks_dropped = 0
+        self._overflowing = False
+
+    #Queue a chunk of transport bytes, called from the transport thread
+    #Never blocks, a full queue drops the chunk so the USB read loop or BLE event loop keeps running
+    def submit(self, data):
+        try:
+            self.chunks.put_nowait((time.perf_counter(), data))
+            self._overflowing = False
+        except queue.Full:
+            self.chunks_dropped += 1
+            if not self._overflowing:
+                self._overflowing = True
+                self.error.emit(f"Pipeline queue full, dropping chunks ({self.chunks_dropped} dropped so far)")
+
+    #Run in background thread until stop()
+    def run(self):
+        self.running = True
+        while self.running:
+            try:
+                item = self.chunks.get(timeout=0.05)
+            except queue.Empty:
+                continue
+            self._process_queued(item)
+
+    #Join everything already queued so one decode covers the whole batch
+    #item is (time submitted, data)
+    def _process_queued(self, item):
+        batch = [item]
+        while True:
+            try:
+                batch.append(self.chunks.get_nowait())
+            except queue.Empty:
+                break
+
+        #Queue latency of the oldest chunk in the batch
+        self.pipeline.stats.record("queue", time.perf_counter() - item[0])
+
+        stored = 0
+        try:
+            stored = self.pipeline.process(b"".join(data for _, data in batch), [submitted for submitted, _ in batch])
+        except Exception as e:
+            self.error.emit(f"Error in pipeline: {str(e)}")
+        finally:
+            for _ in batch:
+                self.chunks.task_done()
+
+        if stored and self.on_processed:
+            self.on_processed()
+
+    #Wait until every queued chunk has been processed, processes here if worker is not running
+    def drain(self):
+        if self.isRunning():
+            self.chunks.join()
+            return
+        while True:
+            try:
+                item = self.chunks.get_nowait()
+            except queue.Empty:
+                return
+            self._process_queued(item)
+
+    #Stop thread, blocks until it exits
+    def stop(self):
+        self.running = False
+        self.wait()
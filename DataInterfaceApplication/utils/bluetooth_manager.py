@@ -4,8 +4,10 @@ Bluetooth manager - Handles Bluetooth connections using Bleak library
 
 #Add bleak library
 import asyncio
+import threading
 from bleak import BleakScanner, BleakClient
-from PyQt6.QtCore import QObject, pyqtSignal, QThread
+from PyQt6.QtCore import Qt, QObject, pyqtSignal, QThread
+from utils.transport_batcher import TransportBatcher
 
 """
 Manages bluetooth connections
@@ -33,6 +35,10 @@ class BluetoothManager(QObject):
         #Characteristic UUIDs
         self.notify_characteristic_uuid = None  #UUID for receiving data
         self.write_characteristic_uuid = None  #UUID for sending data
+
+        #Notifications are coalesced and data_received is emitted at most every ~15 ms
+        self.batcher = TransportBatcher(self.data_received.emit)
+        self._flush_handle = None   #pending loop callback that delivers a held batch
     
     #Scan for devices
     #Returns list of devices(name, address)
@@ -211,12 +217,24 @@ class BluetoothManager(QObject):
     
     #handles notifications
     def _notification_handler(self, sender, data):
-        if isinstance(data, bytearray):
-            data = bytes(data)
-        self.data_received.emit(data)
+        self.batcher.add(data)
+
+        #Make sure a partial batch is delivered even if no further notification arrives
+        wait = self.batcher.time_until_due()
+        if wait is not None and self._flush_handle is None:
+            try:
+                self._flush_handle = asyncio.get_running_loop().call_later(wait, self._flush_batch)
+            except RuntimeError:
+                self.batcher.flush()    #not called from the event loop, deliver now
+
+    #Deliver held notification bytes
+    def _flush_batch(self):
+        self._flush_handle = None
+        self.batcher.flush()
     
     #called when device disconnects
     def _on_disconnect(self, client):
+        self.batcher.flush()
         self.is_connected = False
         self.notify_characteristic_uuid = None
         self.write_characteristic_uuid = None
@@ -231,7 +249,8 @@ class BluetoothManager(QObject):
         self.write_characteristic_uuid = uuid
 
 #Worker thread
-#Runs Bluetooth in separate thread from GUI
+#Long-lived BLE service thread, owns one asyncio event loop for the app lifetime
+#Scan, connect, disconnect and send are submitted to the loop as commands, reconnect runs inside the loop
 class BluetoothWorker(QThread):
     #Define signals
     scan_complete = pyqtSignal(list)    #when scan is complete
@@ -240,18 +259,32 @@ class BluetoothWorker(QThread):
     error = pyqtSignal(str)             #when error occurs
     reconnecting = pyqtSignal(int)      #attempt number when reconnecting
 
+    #One worker shared by device selection and the main application
+    _shared = None
+
+    #Get shared worker, created on first use
+    @classmethod
+    def shared(cls):
+        if cls._shared is None:
+            cls._shared = cls()
+        return cls._shared
+
+    #Stop shared worker thread if it was started (application exit)
+    @classmethod
+    def shutdown_shared(cls):
+        if cls._shared is not None:
+            cls._shared.shutdown()
+
     def __init__(self):
         super().__init__()
 
         #create manager
         self.manager = BluetoothManager()
 
-        #will tell operation
-        self.operation = None  
-        self.params = {}
-
-        #store event loop
+        #event loop, created by run() and kept until shutdown()
         self.loop = None
+        self.loop_ready = threading.Event()
+        self._write_lock = None     #keeps writes in submission order
 
         #connects manager signals to worker signals
         self.manager.scan_complete.connect(self.scan_complete.emit)
@@ -259,12 +292,13 @@ class BluetoothWorker(QThread):
         #ignore name, send connected signal
         self.manager.connected.connect(lambda name: self.connected.emit(True))
 
-        #disconnect
-        self.manager.disconnected.connect(self._handle_disconnect)
+        #disconnect, handled on the loop thread so reconnect starts without waiting for the GUI
+        self.manager.disconnected.connect(self._handle_disconnect, Qt.ConnectionType.DirectConnection)
         #error
         self.manager.error_occurred.connect(self.error.emit)
 
-        self.running = False    #track worker if reconnect needed
+        self.running = False    #connected session wanted, reconnect on dropout
+        self._reconnect_task = None
 
         #Auto reconnect settings
         self.connection_timeout = 5.0
@@ -273,109 +307,106 @@ class BluetoothWorker(QThread):
         self.reconnect_delay = 2.0
         self.last_connected_address = None
 
-    #Runs in background
+    #Runs in background, serves commands until shutdown()
     def run(self):
-            
+        self.loop = asyncio.new_event_loop()
+        asyncio.set_event_loop(self.loop)
+        self._write_lock = asyncio.Lock()
+        self.loop_ready.set()
         try:
-            #Event loop
-            self.loop = asyncio.new_event_loop()
-            asyncio.set_event_loop(self.loop)
-
-            #check operation
-            if self.operation == "scan":
-                #run scan operation
-                self.loop.run_until_complete(
-                    self.manager.scan_devices(self.params.get('timeout',5.0)) #gets timeout, defaults 5 s
-                )
-                self.loop.close()    #close loop after scan
-            elif self.operation == "connect":
-                address = self.params.get('address')
-                self.last_connected_address = address   #store address for reconnect
-                #run connect operation
-                successful = self.loop.run_until_complete(
-                    self.manager.connect_to_device(self.params.get('address'))
-                )
-                if successful:
-                    self.running = True    #program running
-                    
-                    #keep connected while running
-                    while self.running:
-                        try:
-                            self.loop.run_forever()
-                        except Exception as e:
-                            self.error.emit(f"Error in loop: {str(e)}")
-                        
-                        #loop was stopped, check for auto reconnect
-                        if self.running and self.auto_reconnect:
-                            reconnected = self.loop.run_until_complete(self.attempt_reconnect())
-                            if not reconnected:
-                                break
-                        else:
-                            break
-
-                #Drain pending WinRT BLE callbacks before closing loop
-                try:
-                    self.loop.run_until_complete(asyncio.sleep(0.15))
-                except Exception:
-                    pass
-                finally:
-                    if not self.loop.is_closed():
-                        self.loop.close()
-                
+            self.loop.run_forever()
         except Exception as e:
-            if self.loop and not self.loop.is_closed():
-                self.loop.close()
             self.error.emit(f"Error in Bluetooth worker: {str(e)}")
-
-    #Run coroutine for disconnecting and sending
-    def _run_in_loop(self, coroutine):
-        if self.loop and self.loop.is_running():
-            future_loop = asyncio.run_coroutine_threadsafe(coroutine, self.loop)
+        finally:
+            #Disconnect, then drain pending WinRT BLE callbacks before closing loop
             try:
-                return future_loop.result(timeout=5.0) #wait for result
-            except Exception as e:
-                self.error.emit(f"Error within operation: {str(e)}")
-                return None
-        else:
+                self.loop.run_until_complete(self.manager.disconnect())
+                self.loop.run_until_complete(asyncio.sleep(0.15))
+            except Exception:
+                pass
+            self.loop.close()
+            self.loop = None
+            self.loop_ready.clear()
+
+    #Start loop thread if needed and wait until it accepts commands
+    def _ensure_loop(self):
+        if not self.isRunning():
+            self.loop_ready.clear()
+            self.start()
+        self.loop_ready.wait(5.0)
+
+    #Submit coroutine to the loop, returns concurrent future
+    def _submit(self, coroutine):
+        self._ensure_loop()
+        if self.loop is None:
+            coroutine.close()
             self.error.emit("Event loop not running")
             return None
+        return asyncio.run_coroutine_threadsafe(coroutine, self.loop)
 
-    #scan for devices
+    #Run coroutine on the loop and wait for its result
+    def _run_in_loop(self, coroutine, timeout=5.0):
+        future = self._submit(coroutine)
+        if future is None:
+            return None
+        try:
+            return future.result(timeout=timeout) #wait for result
+        except Exception as e:
+            self.error.emit(f"Error within operation: {str(e)}")
+            return None
+
+    #scan for devices, result arrives through scan_complete
     def scan(self, timeout=5.0):
-        if self.isRunning():
-            # If we're connected, disconnect first
-            self.disconnect_device()
-            self.wait()  # wait for the thread to finish
-        self.operation = "scan"
-        self.params = {'timeout': timeout}
-        self.start()
+        self._submit(self.manager.scan_devices(timeout))
         
-    #connect to a device
+    #connect to a device, result arrives through connected
     def connect(self, address):
-        if self.isRunning():
+        if self.manager.is_connected:
             self.error.emit("Already running")
             return
-        #Reset for new connection
-        self.running = False
         self.auto_reconnect = True
-        self.operation = "connect"                 #tell run() to connect
-        self.params = {'address': address}         #store address
-        self.start()
+        self._submit(self._connect(address))
+
+    #Connect command
+    async def _connect(self, address):
+        self.last_connected_address = address   #store address for reconnect
+        successful = await self.manager.connect_to_device(address)
+        self.running = successful
+        if not successful:
+            self.connected.emit(False)
+        return successful
         
     #planned disconnect from device
     def disconnect_device(self):
-        #disconnect and stop event loop
-        if self.loop and self.loop.is_running():
-            self.running = False
-            self.auto_reconnect = False
-            self.last_connected_address = None  #clear stored address
-            self._run_in_loop(self.manager.disconnect())
-            
+        if self.loop is None:
+            return
+        self.running = False
+        self.auto_reconnect = False
+        self.last_connected_address = None  #clear stored address
+        self._run_in_loop(self._disconnect())
+
+    #Disconnect command, cancels a reconnect in progress
+    async def _disconnect(self):
+        if self._reconnect_task and not self._reconnect_task.done():
+            self._reconnect_task.cancel()
+        await self.manager.disconnect()
 
-    #send data to device
+    #send data to device, writes are queued in order and do not block the caller
     def send(self, data):
-        #send using event loop
-        self._run_in_loop(self.manager.send_data(data))
+        self._submit(self._send(data))
+
+    #Send command
+    async def _send(self, data):
+        async with self._write_lock:
+            await self.manager.send_data(data)
+
+    #Stop loop thread, blocks until it exits
+    def shutdown(self):
+        self.running = False
+        self.auto_reconnect = False
+        if self.loop is not None and self.isRunning():
+            self.loop.call_soon_threadsafe(self.loop.stop)
+        self.wait()
 
     #Set connection timeout
     def set_connection_timeout(self, timeout):
@@ -413,6 +444,8 @@ class BluetoothWorker(QThread):
                     if successful:
                         return True
 
+            except asyncio.CancelledError:
+                return False    #planned disconnect during reconnect
             except Exception as e:
                 #if all attempts failed, emit error
                 self.error.emit(f"Reconnect error: {str(e)}")
@@ -423,8 +456,13 @@ class BluetoothWorker(QThread):
         self.disconnected.emit()    #signal device disconnected
         return False    #failed
 
-    #Handle disconnect
+    #Handle disconnect, start reconnect on the loop if the session was not ended on purpose
     def _handle_disconnect(self):
-        #stop event loop
-        if self.loop and self.loop.is_running():
-            self.loop.call_soon_threadsafe(self.loop.stop)
\ No newline at end of file
+        if self.loop is None or not (self.running and self.auto_reconnect):
+            return
+        self.loop.call_soon_threadsafe(self._start_reconnect)
+
+    #Runs on the loop thread
+    def _start_reconnect(self):
+        if self._reconnect_task is None or self._reconnect_task.done():
+            self._reconnect_task = self.loop.create_task(self.attempt_reconnect())
@@ -3,11 +3,14 @@ Butterworth Filter - Low-pass filter for signal smoothing
 """
 
 import numpy as np
+from utils.iir_filter_engine import StreamingCascade
+from utils import filter_design_cache
 
 class ButterworthFilter:
     def __init__(self, cutoff=20.0, sample_rate=1200.0):
         self.cutoff = cutoff
         self.sample_rate = sample_rate
+        self.stream = None      #causal cascade used during acquisition
 
     #Design 4th order Butterworth cascading two 2nd order biquad filters
     def _design_butterworth_filter(self):
@@ -42,22 +45,14 @@ class ButterworthFilter:
 
         return biquad_sections
 
-    #Direct form II, infinite impulse response (IIR) filter implementation
-    def _apply_forward(self, numerator_coefficients, denominator_coefficients, input_signal):
-        output_signal = np.zeros(len(input_signal))
-        for sample_index in range(len(input_signal)):
-            output_signal[sample_index] = numerator_coefficients[0] * input_signal[sample_index]
-            if sample_index >= 1:
-                output_signal[sample_index] += (numerator_coefficients[1] * input_signal[sample_index-1]
-                                              - denominator_coefficients[1] * output_signal[sample_index-1])
-            if sample_index >= 2:
-                output_signal[sample_index] += (numerator_coefficients[2] * input_signal[sample_index-2]
-                                              - denominator_coefficients[2] * output_signal[sample_index-2])
-        return output_signal
+    #Cached sections for current cutoff and sample rate
+    def _design(self):
+        return filter_design_cache.get_design("butterworth", 4, float(self.cutoff), None, self.sample_rate,
+                                              self._design_butterworth_filter)
 
     #Forward backward filtering for zero phase distortion
     #Reflect pad both ends before forward-backward filtering to avoid IIR boundary transient effects
-    def _apply_section_forward_backward(self, numerator_coefficients, denominator_coefficients, input_signal):
+    def _apply_section_forward_backward(self, section, input_signal):
         #Pad length scales with cutoff, clamped to minimum 100 samples
         pad_len = max(100, int(7.0 * self.sample_rate / self.cutoff))
 
@@ -65,9 +60,7 @@ class ButterworthFilter:
         right_pad = input_signal[-(pad_len + 1) : -1][::-1]
         padded    = np.concatenate([left_pad, input_signal, right_pad])
 
-        forward_pass  = self._apply_forward(numerator_coefficients, denominator_coefficients, padded)
-        backward_pass = self._apply_forward(numerator_coefficients, denominator_coefficients, forward_pass[::-1])
-        zero_phase    = backward_pass[::-1]
+        zero_phase = section.filter_forward_backward(padded)
 
         #Remove padding, return same length as original input
         return zero_phase[pad_len : pad_len + len(input_signal)]
@@ -77,17 +70,29 @@ class ButterworthFilter:
         if len(force_data) == 0:
             return list(force_data)
 
-        filtered_signal = np.array(list(force_data), dtype=float)
-        biquad_sections = self._design_butterworth_filter()
+        filtered_signal = np.asarray(force_data, dtype=float)
 
-        for numerator_coefficients, denominator_coefficients in biquad_sections:
-            filtered_signal = self._apply_section_forward_backward(numerator_coefficients, denominator_coefficients, filtered_signal)
+        for section in self._design().sections:
+            filtered_signal = self._apply_section_forward_backward(section, filtered_signal)
 
         return filtered_signal.tolist()
 
+    #Causal (forward only) filtering of the next live block, state carried between calls
+    def process_block(self, block):
+        if self.stream is None:
+            design = self._design()
+            self.stream = StreamingCascade(design.sections, design.unit_states)
+        return self.stream.process(block)
+
+    #Start a new live stream
+    def reset_stream(self):
+        self.stream = None
+
     #Setters
     def set_cutoff(self, cutoff):
         self.cutoff = cutoff
+        self.stream = None
 
     def set_sample_rate(self, sample_rate):
-        self.sample_rate = sample_rate
\ No newline at end of file
+        self.sample_rate = sample_rate
+        self.stream = None
\ No newline at end of file
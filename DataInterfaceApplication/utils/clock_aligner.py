@@ -0,0 +1,78 @@
+"""
+Clock Aligner - Maps a stream's sample times onto the host clock, so several devices share one timeline
+Every chunk gives a bound: the last sample in it was taken no later than the chunk arrived, so
+    arrival - sample_time = clock offset + transport latency (≥ 0)
+Transport latency varies chunk to chunk but has a floor, so the smallest residual in each WINDOW seconds
+of stream time tracks the offset closely. A line through those minima gives the host time of sample zero
+(offset) and the device clock rate error (skew), which is ±100 ppm or so for a crystal and adds up
+to a visible shift over a long trial.
+
+    host_time(t) = offset + t * (1 + skew)      t = sample index / nominal sample rate
+"""
+
+import threading
+import numpy as np
+
+WINDOW = 1.0        #seconds of stream time per minimum
+MIN_SPAN = 5.0      #seconds of stream time before skew is fitted, offset only before that
+
+class ClockAligner:
+    def __init__(self):
+        self.lock = threading.Lock()    #recorded by the pipeline worker, read by the GUI
+        self.reset()
+
+    #Forget all measurements, call at the start of each trial
+    def reset(self):
+        with self.lock:
+            self.window_times = []      #stream time of each window's minimum
+            self.window_minima = []     #smallest arrival - stream time in the window
+            self.offset = None
+            self.skew = 0.0
+
+    #Chunk holding samples up to stream_time (s) arrived at host time arrival (perf_counter)
+    def record(self, arrival, stream_time):
+        residual = arrival - stream_time
+        window = int(stream_time // WINDOW)
+        with self.lock:
+            if self.window_times and int(self.window_times[-1] // WINDOW) == window:
+                if residual < self.window_minima[-1]:
+                    self.window_times[-1] = stream_time
+                    self.window_minima[-1] = residual
+                else:
+                    return
+            else:
+                self.window_times.append(stream_time)
+                self.window_minima.append(residual)
+            self._fit()
+
+    #Offset and skew from the window minima
+    def _fit(self):
+        times = np.asarray(self.window_times)
+        minima = np.asarray(self.window_minima)
+        if len(times) < 3 or times[-1] - times[0] < MIN_SPAN:
+            self.offset = float(minima.min())
+            self.skew = 0.0
+            return
+        slope, intercept = np.polyfit(times, minima, 1)
+        #Latency floor lies under every minimum, shift the line down onto the lowest one
+        self.offset = float(intercept + (minima - (intercept + slope * times)).min())
+        self.skew = float(slope)
+
+    #Host times of stream times, None until the first chunk
+    def to_host(self, stream_times):
+        with self.lock:
+            if self.offset is None:
+                return None
+            return self.offset + np.asarray(stream_times) * (1.0 + self.skew)
+
+    #Stream times of host times, inverse of to_host
+    def to_stream(self, host_times):
+        with self.lock:
+            if self.offset is None:
+                return None
+            return (np.asarray(host_times) - self.offset) / (1.0 + self.skew)
+
+    #(offset, skew) or None until the first chunk
+    def estimate(self):
+        with self.lock:
+            return None if self.offset is None else (self.offset, self.skew)
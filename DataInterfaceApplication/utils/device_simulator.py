@@ -0,0 +1,216 @@
+"""
+Device Simulator - Simulated LSMD device on a pseudo-terminal (Linux/macOS)
+Opens a pty that USBManager/USBWorker connect to like a COM port and speaks the firmware protocol:
+    commands end with \\r or \\n, "start" and "stop" are answered "\\r\\nok_start\\r\\n" / "\\r\\nok_stop\\r\\n"
+    "ping <token>" is answered "\\r\\npong <token>\\r\\n" inline with the samples (latency probe)
+    between them samples are streamed at the configured rate, as ASCII lines ("%u\\r\\n", like adc.c)
+    or binary frames (sync, sequence number, ADC code, see stream_decoder.py)
+
+The trace is a synthetic contraction cycle or ADC values from a session file, looped.
+Faults can be injected to exercise the host: dropped samples (sequence numbers still advance),
+garbage bytes, and bursts where output is held back then released at once.
+Output goes through a bounded transmit buffer like the device UART; if the host does not keep up
+the oldest bytes are lost and counted, so host-side limits show up as overflow rather than blocking.
+
+Usage:
+    simulator = DeviceSimulator(sample_rate=5000, frame_format="binary", drop_rate=0.001)
+    port_name = simulator.open()    #connect USBWorker to port_name
+    ...
+    simulator.close()
+"""
+
+import os
+import select
+import threading
+import time
+import numpy as np
+from utils.stream_decoder import FRAME_DTYPE, FRAME_SYNC
+from utils.session_file import SessionReader
+
+TICK_INTERVAL = 0.001           #seconds between output ticks
+TX_BUFFER_LIMIT = 1 << 20       #bytes held for a slow host before the oldest are lost
+
+#Synthetic trace, one contraction per period: rest, rise (time constant 0.1 s), hold, relax
+def synthetic_trace(sample_rate, period=4.0, rest_level=150.0, peak_level=600.0, noise=2.0, seed=0):
+    t = np.arange(int(period * sample_rate)) / sample_rate
+    onset, release = 0.25 * period, 0.75 * period
+    rise = 1.0 - np.exp(-np.clip(t - onset, 0.0, None) / 0.1)
+    fall = np.exp(-np.clip(t - release, 0.0, None) / 0.15)
+    trace = rest_level + (peak_level - rest_level) * rise * fall
+    trace += np.random.default_rng(seed).normal(0.0, noise, len(t))
+    return np.clip(np.rint(trace), 0, 1023).astype(np.int64)
+
+#Trace from the raw ADC values of a session file
+def session_trace(path):
+    return np.rint(SessionReader(path).samples["adc"]).astype(np.int64)
+
+#Encode samples for the wire, seq is the sequence number of the first sample
+def encode_samples(adc, frame_format, seq):
+    if frame_format == "binary":
+        frames = np.empty(len(adc), dtype=FRAME_DTYPE)
+        frames["sync"] = FRAME_SYNC
+        frames["seq"] = (seq + np.arange(len(adc))) & 0xFFFF
+        frames["adc"] = adc
+        return frames.tobytes()
+    return (("%u\r\n" * len(adc)) % tuple(adc.tolist())).encode("ascii")
+
+class DeviceSimulator:
+    #Initialize with rate in samples/s, "ascii" or "binary" output, trace (ADC array, None = synthetic) and faults
+    #drop_rate: fraction of samples not sent, garbage_rate: garbage insertions per second,
+    #burst_interval/burst_hold: every burst_interval seconds output is held for burst_hold seconds
+    def __init__(self, sample_rate=1200, frame_format="ascii", trace=None, drop_rate=0.0,
+                 garbage_rate=0.0, burst_interval=0.0, burst_hold=0.2, seed=0):
+        if frame_format not in ("ascii", "binary"):
+            raise ValueError(f"Unknown stream format: {frame_format}")
+        self.sample_rate = sample_rate
+        self.frame_format = frame_format
+        self.trace = trace if trace is not None else synthetic_trace(sample_rate, seed=seed)
+        self.drop_rate = drop_rate
+        self.garbage_rate = garbage_rate
+        self.burst_interval = burst_interval
+        self.burst_hold = burst_hold
+        self.rng = np.random.default_rng(seed)
+
+        self.master = None
+        self.slave = None
+        self.port_name = None
+        self.thread = None
+        self.running = False
+        self.streaming = False
+
+        #Statistics
+        self.samples_generated = 0      #sequence numbers used
+        self.samples_dropped = 0        #fault injected drops
+        self.bytes_written = 0
+        self.bytes_lost = 0             #transmit buffer overflow, host too slow
+        self.commands = []              #commands received, in order
+
+    #Create the pty and start the device thread, returns port name to connect to
+    def open(self):
+        import pty
+        import tty
+        self.master, self.slave = pty.openpty()
+        tty.setraw(self.master)
+        tty.setraw(self.slave)
+        os.set_blocking(self.master, False)
+        self.port_name = os.ttyname(self.slave)
+
+        self.running = True
+        self.thread = threading.Thread(target=self._run, name="DeviceSimulator", daemon=True)
+        self.thread.start()
+        return self.port_name
+
+    #Stop the device thread and close the pty
+    def close(self):
+        self.running = False
+        if self.thread is not None:
+            self.thread.join()
+            self.thread = None
+        for fd in (self.master, self.slave):
+            if fd is not None:
+                os.close(fd)
+        self.master = self.slave = None
+
+    #Device loop: read commands, generate due samples, write what the host accepts
+    def _run(self):
+        command = bytearray()
+        tx = bytearray()
+        position = 0            #next sample of the trace
+        stream_start = None     #(time, samples generated) when streaming started, for pacing
+        next_garbage = None
+        next_burst = None
+
+        while self.running:
+            #Commands from the host
+            readable, _, _ = select.select([self.master], [], [], TICK_INTERVAL)
+            if readable:
+                try:
+                    data = os.read(self.master, 4096)
+                except OSError:
+                    data = b""
+                for byte in data:
+                    if byte in (13, 10):
+                        if command:
+                            tx += self._dispatch(command.decode("ascii", errors="ignore"))
+                            command.clear()
+                    else:
+                        command.append(byte)
+
+            now = time.perf_counter()
+            if self.streaming:
+                if stream_start is None:
+                    stream_start = (now, self.samples_generated)
+                    next_garbage = now + self._garbage_gap()
+                    next_burst = now + self.burst_interval if self.burst_interval > 0 else None
+
+                #Samples due since start, generated in one block
+                due = stream_start[1] + int((now - stream_start[0]) * self.sample_rate) - self.samples_generated
+                if due > 0:
+                    indices = (position + np.arange(due)) % len(self.trace)
+                    position = int(indices[-1] + 1) % len(self.trace)
+                    adc = self.trace[indices]
+                    seq = self.samples_generated
+                    self.samples_generated += due
+
+                    block = self._encode_with_drops(adc, seq)
+                    tx += block
+
+                #Garbage bytes between samples
+                if next_garbage is not None and now >= next_garbage:
+                    tx += self.rng.integers(0, 256, int(self.rng.integers(1, 16)), dtype=np.uint8).tobytes()
+                    next_garbage = now + self._garbage_gap()
+            else:
+                stream_start = None
+
+            #Burst fault, output held back then released all at once
+            if next_burst is not None and self.streaming and now >= next_burst:
+                if now < next_burst + self.burst_hold:
+                    continue
+                next_burst = now + self.burst_interval
+
+            tx = self._transmit(tx)
+
+    #Handle one command, returns reply bytes
+    def _dispatch(self, command):
+        command = command.strip()
+        self.commands.append(command)
+        if command == "start":
+            self.streaming = True
+            return b"\r\nok_start\r\n"
+        if command == "stop":
+            self.streaming = False
+            return b"\r\nok_stop\r\n"
+        if command == "ping" or command.startswith("ping "):
+            return f"\r\npong{command[4:]}\r\n".encode("ascii", errors="ignore")
+        return b""      #unknown commands are ignored, as in command.c
+
+    #Encode block, dropped samples are left out but keep their sequence numbers
+    def _encode_with_drops(self, adc, seq):
+        if self.drop_rate <= 0:
+            return encode_samples(adc, self.frame_format, seq)
+        keep = self.rng.random(len(adc)) >= self.drop_rate
+        self.samples_dropped += int(len(adc) - np.count_nonzero(keep))
+        if self.frame_format == "binary":
+            frames = np.frombuffer(encode_samples(adc, self.frame_format, seq), dtype=FRAME_DTYPE)
+            return frames[keep].tobytes()
+        return encode_samples(adc[keep], self.frame_format, seq)
+
+    #Seconds until the next garbage insertion, infinite if disabled
+    def _garbage_gap(self):
+        return self.rng.exponential(1.0 / self.garbage_rate) if self.garbage_rate > 0 else float("inf")
+
+    #Write as much as the host accepts, returns what is left, oldest bytes lost past TX_BUFFER_LIMIT
+    def _transmit(self, tx):
+        if len(tx) > TX_BUFFER_LIMIT:
+            lost = len(tx) - TX_BUFFER_LIMIT
+            self.bytes_lost += lost
+            del tx[:lost]
+        if not tx:
+            return tx
+        try:
+            written = os.write(self.master, tx)
+        except (BlockingIOError, OSError):
+            return tx
+        self.bytes_written += written
+        del tx[:written]
+        return tx
@@ -0,0 +1,163 @@
+"""
+Envelope Pyramid - Multi-resolution min/max summary of a sample stream for plotting
+Level 0 holds min/max of every base_bin samples, each level above halves the resolution
+Maintained incrementally as blocks arrive, so long captures render in time proportional
+to the plot width rather than the number of samples, and peaks are never decimated away
+Bins are counted from origin, the absolute index of the first sample summarised. A store that drops
+its oldest samples passes its own first absolute index to render, so bins stay aligned with the samples,
+and to trim, which drops bins before it so memory stays bounded by the store.
+"""
+
+import numpy as np
+
+#Growable 1D array with amortised O(1) block append
+class _GrowArray:
+    def __init__(self, capacity=256):
+        self.data = np.empty(capacity, dtype=np.float64)
+        self.size = 0
+
+    def extend(self, values):
+        required = self.size + len(values)
+        if required > len(self.data):
+            grown = np.empty(max(required, 2 * len(self.data)), dtype=np.float64)
+            grown[:self.size] = self.data[:self.size]
+            self.data = grown
+        self.data[self.size:required] = values
+        self.size = required
+
+    def view(self):
+        return self.data[:self.size]
+
+    #Remove the first count values
+    def drop_front(self, count):
+        self.data[:self.size - count] = self.data[count:self.size]
+        self.size -= count
+
+    def clear(self):
+        self.size = 0
+
+class EnvelopePyramid:
+    #Initialize with samples per level 0 bin and number of levels
+    def __init__(self, base_bin=4, levels=14):
+        self.base_bin = base_bin
+        self.levels = levels
+        self.mins = [_GrowArray() for _ in range(levels)]
+        self.maxs = [_GrowArray() for _ in range(levels)]
+
+        #Samples not yet part of a complete level 0 bin
+        self.tail = np.empty(0, dtype=np.float64)
+
+        #Total samples appended, absolute sample index of the first one
+        self.count = 0
+        self.origin = 0
+
+    #Samples covered by one bin at a level
+    def bin_size(self, level):
+        return self.base_bin << level
+
+    #Add a block of samples, updates every level that gained a complete bin
+    def append(self, values):
+        values = np.asarray(values, dtype=np.float64)
+        if len(values) == 0:
+            return
+        self.count += len(values)
+
+        pending = np.concatenate((self.tail, values)) if len(self.tail) else values
+        full_bins = len(pending) // self.base_bin
+        self.tail = pending[full_bins * self.base_bin:].copy()
+        if full_bins == 0:
+            return
+
+        blocks = pending[:full_bins * self.base_bin].reshape(full_bins, self.base_bin)
+        self.mins[0].extend(blocks.min(axis=1))
+        self.maxs[0].extend(blocks.max(axis=1))
+
+        #Each level pairs up the bins of the level below that are not yet summarised
+        for level in range(1, self.levels):
+            below_min = self.mins[level - 1].view()
+            below_max = self.maxs[level - 1].view()
+            done = self.mins[level].size
+            target = len(below_min) // 2
+            if target == done:
+                break
+            pair_min = below_min[2 * done:2 * target].reshape(-1, 2)
+            pair_max = below_max[2 * done:2 * target].reshape(-1, 2)
+            self.mins[level].extend(pair_min.min(axis=1))
+            self.maxs[level].extend(pair_max.max(axis=1))
+
+    #Drop bins of samples before absolute index first_index, called after the store drops its oldest samples
+    #Only whole top level bins are dropped, so every level keeps its bin boundaries
+    def trim(self, first_index):
+        step = self.bin_size(self.levels - 1)
+        drop = (first_index - self.origin) // step * step
+        if drop <= 0:
+            return
+        for level in range(self.levels):
+            bins = drop // self.bin_size(level)
+            self.mins[level].drop_front(bins)
+            self.maxs[level].drop_front(bins)
+        self.count -= drop
+        self.origin += drop
+
+    #Discard everything and summarise values from scratch (after filtering or rescaling)
+    #origin is the absolute sample index of values[0]
+    def rebuild(self, values, origin=0):
+        self.clear()
+        self.origin = origin
+        self.append(values)
+
+    #Remove all samples
+    def clear(self):
+        for level in range(self.levels):
+            self.mins[level].clear()
+            self.maxs[level].clear()
+        self.tail = np.empty(0, dtype=np.float64)
+        self.count = 0
+        self.origin = 0
+
+    #Finest level for drawing n samples into max_points points, -1 means draw raw samples
+    def level_for(self, sample_count, max_points):
+        if sample_count <= max_points:
+            return -1
+        for level in range(self.levels):
+            if 2 * (sample_count // self.bin_size(level) + 1) <= max_points // 2:
+                return level
+        return self.levels - 1
+
+    #Indices and values to draw for values[start:stop] with at most ~max_points points
+    #values holds the stored samples, values[0] being absolute sample first_index (not older than origin)
+    #Returned indices are positions in values
+    def render(self, values, start, stop, max_points, first_index=0):
+        shift = first_index - self.origin
+        indices, points = self._render(values, int(start) + shift, int(stop) + shift, max_points, shift)
+        return indices - shift, points
+
+    #render in pyramid coordinates (samples since origin), values[i] is pyramid sample i + shift
+    def _render(self, values, start, stop, max_points, shift):
+        start = max(shift, start)
+        stop = min(self.count, shift + len(values), stop)
+        if stop <= start:
+            return np.empty(0, dtype=np.float64), np.empty(0, dtype=np.float64)
+
+        level = self.level_for(stop - start, max_points)
+        if level < 0:
+            return np.arange(start, stop, dtype=np.float64), values[start - shift:stop - shift]
+
+        size = self.bin_size(level)
+        first_bin = -(-start // size)
+        last_bin = min(stop // size, self.mins[level].size)
+        if last_bin <= first_bin:
+            return np.arange(start, stop, dtype=np.float64), values[start - shift:stop - shift]
+
+        #Each bin becomes two points (min then max) at its first sample, so the line spans the full range
+        bin_starts = np.arange(first_bin, last_bin, dtype=np.float64) * size
+        envelope_x = np.repeat(bin_starts, 2)
+        envelope_y = np.empty(2 * (last_bin - first_bin), dtype=np.float64)
+        envelope_y[0::2] = self.mins[level].view()[first_bin:last_bin]
+        envelope_y[1::2] = self.maxs[level].view()[first_bin:last_bin]
+
+        #Partial bins at either edge are drawn from finer levels (raw samples at the bottom)
+        edge_points = max(max_points // 4, 2)
+        head_x, head_y = self._render(values, start, first_bin * size, edge_points, shift)
+        tail_x, tail_y = self._render(values, last_bin * size, stop, edge_points, shift)
+        return np.concatenate((head_x, envelope_x, tail_x)), np.concatenate((head_y, envelope_y, tail_y))
@@ -0,0 +1,65 @@
+"""
+Filter Design Cache - Reuses designed biquad sections between filter applications
+Designs are keyed by filter type, order, cutoff/notch frequency, bandwidth and sample rate,
+so re-running the same filter (scrubbing a cutoff back and forth, batch processing trials)
+skips the coefficient math and the block matrix setup in Biquad
+Used from the GUI thread and the pipeline worker, the cache is guarded by a lock
+"""
+
+import threading
+from collections import OrderedDict
+import numpy as np
+from utils.iir_filter_engine import Biquad
+
+MAX_DESIGNS = 64    #oldest designs are dropped past this
+
+class FilterDesign:
+    #Initialize from list of (b, a) coefficient pairs, cascaded in order
+    def __init__(self, coefficients):
+        self.coefficients = [(np.asarray(b, dtype=np.float64), np.asarray(a, dtype=np.float64)) for b, a in coefficients]
+        self.sections = [Biquad(b, a) for b, a in self.coefficients]
+
+        #Per section state for a constant input of 1 through the whole cascade, scaled by the first sample to start a stream
+        self.unit_states = []
+        level = 1.0
+        for section in self.sections:
+            self.unit_states.append(section.steady_state(level))
+            level = section.dc_gain * level
+
+    #Steady state of every section for constant input x0
+    def steady_states(self, x0):
+        return [x0 * state for state in self.unit_states]
+
+_designs = OrderedDict()
+_lock = threading.Lock()
+hits = 0
+misses = 0
+
+#Return cached design for key, calling design_function() for the (b, a) pairs on a miss
+def get_design(kind, order, frequency, bandwidth, sample_rate, design_function):
+    global hits, misses
+    key = (kind, int(order), frequency, bandwidth, float(sample_rate))
+
+    with _lock:
+        design = _designs.get(key)
+        if design is not None:
+            hits += 1
+            _designs.move_to_end(key)
+            return design
+        misses += 1
+
+    #Designed outside the lock, a design made twice by two threads at once is harmless
+    design = FilterDesign(design_function())
+    with _lock:
+        _designs[key] = design
+        if len(_designs) > MAX_DESIGNS:
+            _designs.popitem(last=False)
+    return design
+
+#Drop all cached designs
+def clear():
+    global hits, misses
+    with _lock:
+        _designs.clear()
+        hits = 0
+        misses = 0
@@ -0,0 +1,213 @@
+"""
+Headless Acquisition - Timed trials without the GUI, driven by the command line interface
+Connects a USB, BLE or replay transport and routes its data straight into the same
+AcquisitionPipeline the dashboard uses. Each trial sends "start", runs for a fixed duration,
+sends "stop", then drains the pipeline, closes the session file and prints peak/RTD and
+throughput. Trials repeat with a rest in between, then the transport is disconnected.
+With a latency probe interval the device is pinged during each trial and round trip and
+sample-to-pipeline latency are appended to latency.jsonl in the output folder.
+"""
+
+import os
+import time
+from PyQt6.QtCore import QObject, QTimer, Qt, pyqtSignal
+from utils.acquisition_pipeline import AcquisitionPipeline, PipelineWorker
+from utils.session_file import SessionWriter, new_session_path
+from utils.torque_analysis import analyze_trial, RTD_WINDOWS
+from utils.latency_probe import LatencyProbe
+
+class HeadlessAcquisition(QObject):
+    #Define signals
+    finished = pyqtSignal()     #all trials done or connection failed
+
+    #Initialize with parsed acquire arguments, calibration (or None) and filter list
+    def __init__(self, args, calibration, filters):
+        super().__init__()
+        self.args = args
+        self.limb_length_m = args.limb_length or 0.50
+        self.exit_code = 0
+
+        #Pipeline keeps the whole trial for analysis, sized for the expected length and grown past it
+        #(unthrottled replay delivers far more than duration * sample rate)
+        capacity = int(args.sample_rate * (args.duration + 2.0))
+        self.pipeline = AcquisitionPipeline(capacity, args.sample_rate, growable=True)
+        self.pipeline.piecewise_cal = calibration
+        self.pipeline.zero_offset = args.zero_offset
+        self.pipeline.set_limb_length(self.limb_length_m)
+        self.pipeline.set_filters(filters, causal=True)
+        self.pipeline.stream_decoder.set_format(args.format)
+        self.pipeline_worker = PipelineWorker(self.pipeline)
+        self.pipeline_worker.error.connect(lambda message: print(message))
+
+        #Latency probe, pings sent while each trial runs
+        self.latency_probe = None
+        self.ping_timer = QTimer()
+        if args.latency_probe:
+            self.latency_probe = LatencyProbe()
+            self.pipeline.latency_probe = self.latency_probe
+            self.ping_timer.setInterval(int(args.latency_probe * 1000))
+            self.ping_timer.timeout.connect(lambda: self.send(self.latency_probe.ping()))
+
+        self.transport = None
+        self.connection_type = None
+        self.trial = 0
+        self.trial_start = None
+        self.total_samples = 0
+        self.total_time = 0.0
+
+    #Create transport and connect, trials start once connected
+    def begin(self):
+        args = self.args
+        self.pipeline_worker.start()
+
+        if args.replay:
+            from utils.replay_worker import ReplayWorker
+            self.connection_type = "replay"
+            self.transport = ReplayWorker(args.replay, speed=args.speed, sample_rate=args.sample_rate,
+                                          calibration=self.pipeline.piecewise_cal, zero_offset=args.zero_offset,
+                                          limb_length_m=self.limb_length_m)
+        elif args.ble:
+            from utils.bluetooth_manager import BluetoothWorker
+            self.connection_type = "bluetooth"
+            self.transport = BluetoothWorker.shared()
+        else:
+            from utils.usb_manager import USBWorker
+            self.connection_type = "usb"
+            self.transport = USBWorker()
+            self.transport.manager.set_baud_rate(args.baud)
+
+        self.transport.connected.connect(self.on_connected)
+        self.transport.error.connect(lambda message: print(f"Transport error: {message}"))
+
+        #Data goes from the transport thread straight into the pipeline queue
+        data_signal = self.transport.manager.data_received if self.connection_type == "bluetooth" else self.transport.data_received
+        data_signal.connect(self.pipeline_worker.submit, Qt.ConnectionType.DirectConnection)
+
+        print(f"Connecting ({self.connection_type})...")
+        if self.connection_type == "replay":
+            self.transport.connect()
+        else:
+            self.transport.connect(args.ble or args.usb)
+
+    #Connection result
+    def on_connected(self, success):
+        if not success:
+            print("Connection failed")
+            self.exit_code = 1
+            self.finish()
+            return
+        if self.trial == 0:
+            print("Connected")
+            QTimer.singleShot(0, self.start_trial)
+
+    #Start next trial
+    def start_trial(self):
+        self.trial += 1
+        self.pipeline_worker.drain()
+        self.pipeline.reset()
+
+        #Every trial is recorded, if its session file cannot be created the run stops without starting the device
+        try:
+            path = new_session_path(self.args.output, f"_trial{self.trial:03d}" if self.args.trials > 1 else "")
+            self.pipeline.session_writer = SessionWriter(path, self.args.sample_rate,
+                                                         calibration=self.pipeline.piecewise_cal,
+                                                         zero_offset=self.args.zero_offset,
+                                                         limb_length_m=self.limb_length_m)
+        except OSError as e:
+            print(f"{self.args.output}: {str(e)}")
+            print(f"Trial {self.trial}/{self.args.trials} not started, session file could not be created")
+            self.exit_code = 1
+            self.send("stop")
+            self.finish()
+            return
+        self.session_path = path
+
+        self.trial_start = time.perf_counter()
+        self.send("start")
+        if self.latency_probe is not None:
+            self.latency_probe.reset()
+            self.ping_timer.start()
+        QTimer.singleShot(int(self.args.duration * 1000), self.stop_trial)
+
+    #End current trial, report results and schedule the next
+    def stop_trial(self):
+        self.ping_timer.stop()
+        self.send("stop")
+        self.pipeline_worker.drain()
+        elapsed = time.perf_counter() - self.trial_start
+
+        writer = self.pipeline.take_session_writer()
+        writer.close()
+
+        #Zero-phase filtering over the whole trial, as the dashboard does after stop
+        if self.pipeline.filters:
+            self.pipeline.set_filters(self.pipeline.filters, causal=False)
+        with self.pipeline.lock:
+            analysis = analyze_trial(self.pipeline.samples.view("time"), self.pipeline.samples.view("torque"))
+            samples = self.pipeline.sample_count
+
+        self.total_samples += samples
+        self.total_time += elapsed
+        rtd = "  ".join(f"RTD{window * 1000:.0f} {analysis.rtd_windows[window]:.1f}"
+                        for window in RTD_WINDOWS if analysis.rtd_windows.get(window) is not None)
+        onset = f"{analysis.onset_time:.3f} s" if analysis.onset_time is not None else "—"
+        peak = analysis.peak_torque if analysis.peak_torque is not None else 0.0
+        print(f"Trial {self.trial}/{self.args.trials}: {samples} samples in {elapsed:.2f} s "
+              f"({samples / elapsed:,.0f} samples/s), dropped chunks {self.pipeline_worker.chunks_dropped}")
+        print(f"    peak {peak:.2f} N·m  onset {onset}  {rtd}")
+        print(f"    saved {self.session_path}")
+        print(self.pipeline.stats.report())
+        print(self.pipeline.monitor.report())
+        if self.pipeline.samples_lost:
+            gaps = ", ".join(f"{missing} at {gap_time:.3f} s" for gap_time, missing in self.pipeline.gaps[:10])
+            more = f" (+{len(self.pipeline.gaps) - 10} more)" if len(self.pipeline.gaps) > 10 else ""
+            print(f"    samples lost: {self.pipeline.samples_lost} in {len(self.pipeline.gaps)} gaps: {gaps}{more}")
+        decoder = self.pipeline.stream_decoder
+        if decoder.frames_dropped or decoder.resyncs:
+            print(f"    frames dropped (duplicate or corrupted sequence): {decoder.frames_dropped}, resyncs: {decoder.resyncs}")
+        if self.latency_probe is not None:
+            self.save_latency_probe()
+
+        if self.trial < self.args.trials:
+            QTimer.singleShot(int(self.args.rest * 1000), self.start_trial)
+        else:
+            self.finish()
+
+    #Print probe results of the trial and append them to the log in the output folder
+    def save_latency_probe(self):
+        print(self.latency_probe.report())
+        config = {
+            "sample_rate": self.args.sample_rate,
+            "format": self.args.format,
+            "filters": [type(f).__name__ for f in self.pipeline.filters],
+            "interval": self.args.latency_probe,
+            "headless": True,
+        }
+        path = os.path.join(self.args.output, "latency.jsonl")
+        try:
+            self.latency_probe.save(path, self.connection_type, config)
+        except OSError as e:
+            print(f"    latency results not saved: {str(e)}")
+
+    #Send command to device
+    def send(self, command):
+        if self.connection_type == "usb":
+            self.transport.manager.send_data(command)
+        else:
+            self.transport.send(command)
+
+    #Disconnect, stop threads and report totals
+    def finish(self):
+        if self.transport is not None:
+            if self.connection_type == "bluetooth":
+                self.transport.disconnect_device()
+                self.transport.shutdown_shared()
+            else:
+                self.transport.disconnect()
+                self.transport.wait()
+        self.pipeline_worker.stop()
+
+        if self.total_time > 0:
+            print(f"Total: {self.total_samples} samples in {self.total_time:.2f} s "
+                  f"({self.total_samples / self.total_time:,.0f} samples/s)")
+        self.finished.emit()
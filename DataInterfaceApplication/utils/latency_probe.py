@@ -0,0 +1,126 @@
+"""
+Latency Probe - Command round trip and sample-to-display latency of the live data path
+While acquiring, the host sends "ping <n>" every interval. The device answers "pong <n>" inline with
+the samples (command.c), so the reply sits between the samples taken before and after the ping was handled.
+
+Measured per ping, all on the host perf_counter clock:
+    rtt      - ping sent to the chunk holding the pong arriving from the transport
+    stored   - sample after the pong stored by the pipeline (decode, calibrate, filter done)
+    display  - sample after the pong drawn by a plot update (GUI only)
+stored and display are counted from when the device saw the ping, taken as sent + rtt / 2.
+
+Results are appended as one JSON line per trial with link and configuration, so runs over USB and
+BLE or with different chunk, queue or frame rate settings can be compared (lsmd_cli.py latency).
+"""
+
+import json
+import threading
+import time
+import numpy as np
+
+PERCENTILES = (50, 95, 99)
+MEASURES = ("rtt", "stored", "display")
+
+#Percentile summary of a list of latencies in seconds, values in ms
+def summarize(values):
+    if len(values) == 0:
+        return {"count": 0}
+    ms = np.asarray(values, dtype=np.float64) * 1000.0
+    summary = {"count": len(ms)}
+    for percentile in PERCENTILES:
+        summary[f"p{percentile}"] = float(np.percentile(ms, percentile))
+    summary["max"] = float(ms.max())
+    return summary
+
+#One line per measure for the console
+def format_summary(summaries):
+    lines = []
+    for measure in MEASURES:
+        summary = summaries.get(measure, {"count": 0})
+        if summary["count"] == 0:
+            continue
+        lines.append(f"    {measure:<8} n={summary['count']:<5} " +
+                     "  ".join(f"p{p} {summary[f'p{p}']:7.1f} ms" for p in PERCENTILES) +
+                     f"  max {summary['max']:7.1f} ms")
+    return "\n".join(lines)
+
+class LatencyProbe:
+    def __init__(self):
+        self.lock = threading.Lock()    #pings from the GUI thread, pongs and stores from the worker
+        self.reset()
+
+    #Forget all measurements, call at the start of each trial
+    def reset(self):
+        with self.lock:
+            self.next_token = 1
+            self.sent = {}              #token -> send time
+            self.waiting_store = []     #(sample index, device time) not yet stored
+            self.waiting_display = []   #(sample index, device time) not yet drawn
+            self.values = {measure: [] for measure in MEASURES}
+
+    #Next ping command, its send time is recorded now
+    def ping(self):
+        with self.lock:
+            token = self.next_token
+            self.next_token += 1
+            self.sent[str(token)] = time.perf_counter()
+            return f"ping {token}"
+
+    #Pong decoded, index is the sample that follows it, arrival the transport time of its chunk
+    def on_pong(self, token, index, arrival):
+        with self.lock:
+            sent = self.sent.pop(token, None)
+            if sent is None:
+                return
+            rtt = arrival - sent
+            self.values["rtt"].append(rtt)
+            device_time = sent + rtt / 2.0
+            self.waiting_store.append((index, device_time))
+            self.waiting_display.append((index, device_time))
+
+    #Samples up to last_index were stored by the pipeline
+    def on_stored(self, last_index):
+        self._complete("stored", self.waiting_store, last_index)
+
+    #Samples up to last_index were drawn
+    def on_displayed(self, last_index):
+        self._complete("display", self.waiting_display, last_index)
+
+    #Record latency of every waiting probe whose sample is now covered
+    def _complete(self, measure, waiting, last_index):
+        if not waiting:
+            return
+        now = time.perf_counter()
+        with self.lock:
+            while waiting and waiting[0][0] <= last_index:
+                _, device_time = waiting.pop(0)
+                self.values[measure].append(now - device_time)
+
+    #Percentile summary per measure
+    def summary(self):
+        with self.lock:
+            return {measure: summarize(values) for measure, values in self.values.items()}
+
+    #Multi-line summary for the console
+    def report(self):
+        with self.lock:
+            unanswered = len(self.sent)
+            pings = self.next_token - 1
+        summaries = self.summary()
+        header = f"Latency probe: {pings} pings, {unanswered} unanswered"
+        body = format_summary(summaries)
+        return f"{header}\n{body}" if body else header
+
+    #Append this trial's raw values (ms) with link and configuration to a JSON lines file
+    def save(self, path, link, config):
+        with self.lock:
+            record = {
+                "time": time.strftime("%Y-%m-%dT%H:%M:%S"),
+                "link": link,
+                "config": config,
+                "unanswered": len(self.sent),
+            }
+            for measure, values in self.values.items():
+                record[measure] = [round(value * 1000.0, 3) for value in values]
+        with open(path, "a", encoding="utf-8") as f:
+            f.write(json.dumps(record) + "\n")
@@ -1,11 +1,15 @@
 """
 Moving Average Filter - Smooths data by averaging over a window
+Window sums come from a cumulative sum, so cost per sample does not depend on window size
 """
 
+import numpy as np
+
 class MovingAverageFilter:
     #Initialize with window size 20
     def __init__(self, window_size=20):
         self.window_size = window_size
+        self.stream_history = None      #last window_size - 1 samples of the live stream
 
     #Apply filter to data, returns filtered list of data
     def apply(self, force_data):
@@ -13,27 +17,55 @@ class MovingAverageFilter:
         Apply moving average filter to a list/deque of force values.
         Returns a filtered list.
         """
-        data = list(force_data)
-        return self._moving_average(data, self.window_size)
+        data = np.asarray(force_data, dtype=np.float64)
+        return self._moving_average(data, self.window_size).tolist()
 
-    #Moving average implementation, reflect pads only incomplete first and last 'half' samples
+    #Moving average implementation, centred window is cut short at the first and last 'half' samples
     def _moving_average(self, data, window_size):
-        if len(data) == 0:
-            return []
+        count = len(data)
+        if count == 0:
+            return np.empty(0, dtype=np.float64)
 
-        smoothed = []
+        #Window [start, end) for every sample, sum is difference of two cumulative sums
         half = window_size // 2
-        for i in range(len(data)):
-            start = max(0, i - half)
-            end = min(len(data), i + half + 1)
-            window = data[start:end]
-            smoothed.append(sum(window) / len(window))
+        index = np.arange(count)
+        start = np.maximum(index - half, 0)
+        end = np.minimum(index + half + 1, count)
+
+        cumulative = np.empty(count + 1, dtype=np.float64)
+        cumulative[0] = 0.0
+        np.cumsum(data, out=cumulative[1:])
+        return (cumulative[end] - cumulative[start]) / (end - start)
+
+    #Causal (trailing window) average of the next live block, history carried between calls
+    def process_block(self, block):
+        block = np.asarray(block, dtype=np.float64)
+        if len(block) == 0:
+            return block
+
+        #First block, history holds the first sample so the output starts at its level
+        if self.stream_history is None:
+            self.stream_history = np.full(self.window_size - 1, block[0])
+
+        #Running sum over history + block, output k averages samples k .. k + window_size - 1
+        extended = np.concatenate((self.stream_history, block))
+        cumulative = np.empty(len(extended) + 1, dtype=np.float64)
+        cumulative[0] = 0.0
+        np.cumsum(extended, out=cumulative[1:])
+        smoothed = (cumulative[self.window_size:] - cumulative[:len(block)]) / self.window_size
+
+        self.stream_history = extended[len(block):]
         return smoothed
 
+    #Start a new live stream
+    def reset_stream(self):
+        self.stream_history = None
+
     #Set window size
     def set_window_size(self, window_size):
         self.window_size = window_size
+        self.stream_history = None
     
     #Get window size
     def get_window_size(self):
-        return self.window_size
\ No newline at end of file
+        return self.window_size
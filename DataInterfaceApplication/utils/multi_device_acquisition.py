@@ -0,0 +1,217 @@
+"""
+Multi Device Acquisition - Several devices acquired at once onto one timeline (e.g. bilateral limb testing)
+Each device gets its own transport worker, AcquisitionPipeline and PipelineWorker thread, so decoding,
+calibration and filtering of one stream never waits on another or on the GUI. Transport threads submit
+straight into their pipeline's queue, the GUI only pulls snapshots at its frame rate.
+
+Each pipeline's clock aligner maps its sample times onto the host clock. The shared timeline starts
+at the earliest device's first sample, every other device is shifted (and rate corrected) onto it.
+
+DeviceStream            - one device: transport, pipeline, worker, session file
+MultiDeviceAcquisition  - starts, stops and aligns a set of DeviceStreams
+
+Device specs (main.py --devices or the Multiple Devices card of the connection window, one per device):
+    usb:COM3  usb:/dev/ttyUSB0@230400  ble:AA:BB:CC:DD:EE:FF  replay:sessions/left.lsmd
+"""
+
+from copy import deepcopy
+from PyQt6.QtCore import QObject, Qt, pyqtSignal
+from utils.acquisition_pipeline import AcquisitionPipeline, PipelineWorker
+from utils.session_file import SessionWriter, new_session_path
+
+DEVICE_KINDS = ("usb", "ble", "replay")
+
+#Split "kind:target" into (kind, target, baud), baud only for usb targets ending in @rate
+def parse_device_spec(spec):
+    kind, _, target = spec.partition(":")
+    kind = kind.lower()
+    if kind not in DEVICE_KINDS or not target:
+        raise ValueError(f"Device must be usb:PORT, ble:ADDRESS or replay:FILE, got {spec}")
+    baud = 115200
+    if kind == "usb" and "@" in target:
+        target, _, rate = target.rpartition("@")
+        baud = int(rate)
+    return kind, target, baud
+
+#One device with its own transport, pipeline and worker thread
+class DeviceStream(QObject):
+    #Define signals
+    connected = pyqtSignal(bool)    #transport opened/failed
+
+    #Initialize with kind ("usb", "ble", "replay"), port/address/path and pipeline settings
+    #on_processed runs on the worker thread after new samples are stored
+    def __init__(self, name, kind, target, baud_rate=115200, sample_rate=1200, capacity_seconds=60,
+                 on_processed=None):
+        super().__init__()
+        self.name = name
+        self.kind = kind
+        self.target = target
+        self.baud_rate = baud_rate
+        self.is_connected = False
+        self.acquiring = False
+
+        self.pipeline = AcquisitionPipeline(int(sample_rate * capacity_seconds), sample_rate, growable=True)
+        self.worker = PipelineWorker(self.pipeline, on_processed=on_processed)
+        self.worker.error.connect(lambda message: print(f"{self.name}: {message}"))
+        self.worker.start()
+        self.session_path = None
+
+        #Own transport per device, BLE included (not the shared worker, each bridge needs its own loop)
+        if kind == "ble":
+            from utils.bluetooth_manager import BluetoothWorker
+            self.transport = BluetoothWorker()
+            data_signal = self.transport.manager.data_received
+        elif kind == "replay":
+            from utils.replay_worker import ReplayWorker
+            self.transport = ReplayWorker(target, sample_rate=sample_rate)
+            data_signal = self.transport.data_received
+        else:
+            from utils.usb_manager import USBWorker
+            self.transport = USBWorker()
+            self.transport.manager.set_baud_rate(baud_rate)
+            data_signal = self.transport.data_received
+
+        self.transport.connected.connect(self._on_connected)
+        self.transport.error.connect(lambda message: print(f"{self.name}: {message}"))
+        data_signal.connect(self._on_data, Qt.ConnectionType.DirectConnection)
+
+    #Open transport, result arrives through connected
+    def connect_device(self):
+        if self.kind == "replay":
+            self.transport.connect()
+        else:
+            self.transport.connect(self.target)
+
+    def _on_connected(self, success):
+        self.is_connected = success
+        self.connected.emit(success)
+
+    #Runs on the transport thread, samples only go to the pipeline while acquiring
+    def _on_data(self, data):
+        if self.acquiring:
+            self.worker.submit(data)
+
+    #Send command to device
+    def send(self, command):
+        if self.kind == "usb":
+            self.transport.manager.send_data(command)
+        else:
+            self.transport.send(command)
+
+    #Clear pipeline, open session file if session_dir is set and tell device to start
+    def start(self, calibration, limb_length_m, filters, session_dir=None):
+        self.worker.drain()
+        self.pipeline.piecewise_cal = calibration
+        self.pipeline.set_limb_length(limb_length_m)
+        self.pipeline.set_filters(filters, causal=True)
+        self.pipeline.reset()
+        if session_dir:
+            try:
+                self.session_path = new_session_path(session_dir, f"_{self.name}")
+                self.pipeline.session_writer = SessionWriter(self.session_path, self.pipeline.sample_rate,
+                                                             calibration=calibration, limb_length_m=limb_length_m)
+            except OSError as e:
+                self.session_path = None
+                print(f"{self.name}: session file not created: {str(e)}")
+        self.acquiring = True
+        self.send("start")
+
+    #Tell device to stop and process what is still queued
+    def stop(self):
+        self.send("stop")
+        self.acquiring = False
+        self.worker.drain()
+
+    #Finish session file, header records device name and alignment onto the shared timeline
+    def close_session(self, shift, skew):
+        writer = self.pipeline.take_session_writer()
+        if writer is None:
+            return
+        writer.header["device"] = f"{self.kind}:{self.target}"
+        writer.header["timeline_shift_s"] = shift
+        writer.header["clock_skew_ppm"] = skew * 1e6 if skew is not None else None
+        writer.close()
+        print(f"{self.name}: session saved, {writer.sample_count} samples to {writer.path}")
+
+    #Close transport and stop worker thread
+    def close(self):
+        self.acquiring = False
+        if self.kind == "ble":
+            self.transport.disconnect_device()
+            self.transport.shutdown()
+        else:
+            self.transport.disconnect()
+            self.transport.wait()
+        self.worker.stop()
+        writer = self.pipeline.take_session_writer()
+        if writer is not None:
+            writer.close()
+
+class MultiDeviceAcquisition(QObject):
+    #Define signals
+    device_connected = pyqtSignal(int, bool)    #device number, success
+
+    #Initialize with device specs, on_processed runs on a worker thread whenever any device stored samples
+    def __init__(self, specs, sample_rate=1200, on_processed=None):
+        super().__init__()
+        self.streams = []
+        for number, spec in enumerate(specs):
+            kind, target, baud = parse_device_spec(spec)
+            name = f"{kind}{number + 1}"
+            stream = DeviceStream(name, kind, target, baud_rate=baud, sample_rate=sample_rate, on_processed=on_processed)
+            stream.connected.connect(lambda success, number=number: self.device_connected.emit(number, success))
+            self.streams.append(stream)
+        self.is_acquiring = False
+
+    #Open every transport
+    def connect_all(self):
+        for stream in self.streams:
+            stream.connect_device()
+
+    #Start all connected devices
+    def start(self, calibration, limb_length_m, filters, session_dir=None):
+        for stream in self.streams:
+            if stream.is_connected:
+                #Filter objects carry stream state, every device gets its own copies
+                stream.start(calibration, limb_length_m, [_copy_filter(f) for f in filters], session_dir)
+        self.is_acquiring = True
+
+    #Replace filters of every device with own copies, causal while acquiring, otherwise zero-phase over the stored trial
+    def set_filters(self, filters):
+        for stream in self.streams:
+            stream.pipeline.set_filters([_copy_filter(f) for f in filters], causal=stream.acquiring)
+
+    #Stop all devices, session headers get the alignment of each device
+    def stop(self):
+        for stream in self.streams:
+            if stream.acquiring:
+                stream.stop()
+        self.is_acquiring = False
+        shifts = self.alignment()
+        for stream, alignment in zip(self.streams, shifts):
+            shift, skew = alignment if alignment is not None else (None, None)
+            stream.close_session(shift, skew)
+            print(f"{stream.name}: {stream.pipeline.sample_count} samples, " +
+                  (f"shift {shift * 1000:+.1f} ms, skew {skew * 1e6:+.0f} ppm" if alignment else "not aligned"))
+            print(stream.pipeline.monitor.report())
+
+    #Per stream (shift in s onto the shared timeline, skew) or None if no data yet
+    #Shared time of a stream sample at stream time t = shift + t * (1 + skew)
+    def alignment(self):
+        estimates = [stream.pipeline.clock.estimate() for stream in self.streams]
+        offsets = [estimate[0] for estimate in estimates if estimate is not None]
+        if not offsets:
+            return [None] * len(self.streams)
+        origin = min(offsets)
+        return [None if estimate is None else (estimate[0] - origin, estimate[1]) for estimate in estimates]
+
+    #Disconnect every device and stop all threads
+    def close(self):
+        for stream in self.streams:
+            stream.close()
+
+#Independent copy of a filter with the same settings, state is not shared between devices
+def _copy_filter(f):
+    copy = deepcopy(f)
+    copy.reset_stream()
+    return copy
@@ -3,6 +3,8 @@ Notch Filter - Attenuates specific frequency bands
 """
 
 import numpy as np
+from utils.iir_filter_engine import StreamingCascade
+from utils import filter_design_cache
 
 class NotchFilter:
     #Initialize with frequency to attenuate, bandwidth and sample rate
@@ -10,6 +12,8 @@ class NotchFilter:
         self.notch_frequency = frequency
         self.notch_bandwidth = bandwidth
         self.sample_rate = sample_rate
+        self.target_frequencies = [50.0, 60.0] #change as required, initially was 50, 60, 100, 120, 150, 180
+        self.stream = None      #causal cascade used during acquisition
 
     #Compute filter coefficients
     def _design_notch_filter(self, frequency):
@@ -23,40 +27,40 @@ class NotchFilter:
 
         return b, a
 
-    #Apply IIR filter in one direction
-    def _apply_forward(self, b, a, data):
-        output = np.zeros(len(data))
-        for i in range(len(data)):
-            output[i] = b[0] * data[i]
-            if i >= 1:
-                output[i] += b[1] * data[i-1] - a[1] * output[i-1]
-            if i >= 2:
-                output[i] += b[2] * data[i-2] - a[2] * output[i-2]
-        return output
-
-    #Forward backward filtering for zero phase distortion
-    def _apply_forward_backward(self, b, a, data):
-        forward = self._apply_forward(b, a, data)
-        backward = self._apply_forward(b, a, forward[::-1])
-        return backward[::-1]
+    #Cached sections for every target frequency, cascaded in order
+    def _design(self):
+        return filter_design_cache.get_design("notch", 2, tuple(self.target_frequencies), float(self.notch_bandwidth),
+                                              self.sample_rate,
+                                              lambda: [self._design_notch_filter(freq) for freq in self.target_frequencies])
 
     #Apply filter to a list/deque of force values, returns filtered list
+    #Forward backward filtering for zero phase distortion
     def apply(self, force_data):
-        data = np.array(list(force_data), dtype=float)
-        
-        target_frequencies = [50.0, 60.0] #change as required, initially was 50, 60, 100, 120, 150, 180
+        data = np.asarray(force_data, dtype=float)
 
-        for freq in target_frequencies:
-            b, a = self._design_notch_filter(freq)
-            data = self._apply_forward_backward(b, a, data)
+        for section in self._design().sections:
+            data = section.filter_forward_backward(data)
         
         return data.tolist()
 
+    #Causal (forward only) filtering of the next live block, state carried between calls
+    def process_block(self, block):
+        if self.stream is None:
+            design = self._design()
+            self.stream = StreamingCascade(design.sections, design.unit_states)
+        return self.stream.process(block)
+
+    #Start a new live stream
+    def reset_stream(self):
+        self.stream = None
+
     def set_notch_freq(self, freq):
         self.notch_frequency = freq
 
     def set_bandwidth(self, bandwidth):
         self.notch_bandwidth = bandwidth
+        self.stream = None
 
     def set_sample_rate(self, rate):
-        self.sample_rate = rate
\ No newline at end of file
+        self.sample_rate = rate
+        self.stream = None
\ No newline at end of file
@@ -23,17 +23,25 @@ Usage:
     cal.load_points([(0.0, 102.3), (25.0, 307.8), (50.0, 512.1), (75.0, 718.5), (100.0, 921.0)])
     corrected = cal.adc_to_newtons(410.0)
     corrected_list = cal.adc_to_newtons_list([410.0, 510.2, 615.8])
+    corrected_array = cal.adc_to_newtons_array(np.array([410, 510, 615]))
  
 Interpolation formula between two bracketing points:
     F = N_low + (ADC_raw - ADC_low) * (N_high - N_low) / (ADC_high - ADC_low)
  
 For ADC values outside the calibration range, extrapolation uses the slope
 of the nearest segment (first or last pair of calibration points).
+
+The ADC is 10 bit, so every possible integer code is converted once when points are
+loaded into a dense code table. Integer samples are then a single array gather;
+fractional (filtered/averaged) inputs use the same segment formula vectorized.
 """
 
 import json
 import os
 from datetime import date
+import numpy as np
+
+ADC_CODES = 1024    #10 bit ADC
  
 class PiecewiseLinearCalibration:
     def __init__(self):
@@ -45,6 +53,9 @@ class PiecewiseLinearCalibration:
         self.is_calibrated = False
 
         self.calibration_date = None
+
+        #Newtons for every integer ADC code, None until calibrated
+        self.code_table = None
  
     #Load calibration points and build the sorted lookup table
     #Points are (newton_value, adc_value) tuples from the 5-point capture process
@@ -58,14 +69,17 @@ class PiecewiseLinearCalibration:
             key=lambda pair: pair[0]
         )
         self.is_calibrated = True
+        self._build_code_table()
  
     #Convert a single raw ADC value to calibrated Newtons
     #Finds the two bracketing calibration points and linearly interpolates
     def adc_to_newtons(self, adc_raw):
         if not self.is_calibrated or len(self.lookup_table) < 2:
             return adc_raw
- 
-        table = self.lookup_table
+
+        #Integer code, read straight from the dense table
+        if self.code_table is not None and float(adc_raw).is_integer() and 0 <= adc_raw < ADC_CODES:
+            return float(self.code_table[int(adc_raw)])
  
         #Find the two bracketing calibration points
         adc_low, newton_low, adc_high, newton_high = self._find_bracket(adc_raw)
@@ -81,7 +95,70 @@ class PiecewiseLinearCalibration:
  
     #Convert a list of raw ADC values to calibrated Newtons
     def adc_to_newtons_list(self, adc_values):
-        return [self.adc_to_newtons(adc) for adc in adc_values]
+        if not self.is_calibrated or len(self.lookup_table) < 2:
+            return list(adc_values)
+        return self.adc_to_newtons_array(adc_values).tolist()
+
+    #Convert an array of raw ADC values to calibrated Newtons, returns float64 array
+    def adc_to_newtons_array(self, adc_values):
+        adc = np.asarray(adc_values, dtype=np.float64)
+        if not self.is_calibrated or len(self.lookup_table) < 2:
+            return adc.copy()
+        if self.code_table is None:
+            self._build_code_table()
+
+        #All samples are in range integer codes, one gather
+        codes = adc.astype(np.intp)
+        if len(adc) and codes.min() >= 0 and codes.max() < ADC_CODES and np.array_equal(codes, adc):
+            return self.code_table[codes]
+
+        return self._interpolate_array(adc)
+
+    #Segment formula for a whole array, same brackets as _find_bracket()
+    def _interpolate_array(self, adc):
+        adc_points = np.array([pair[0] for pair in self.lookup_table], dtype=np.float64)
+        newton_points = np.array([pair[1] for pair in self.lookup_table], dtype=np.float64)
+
+        #Segment i spans points i and i+1, a value on a point uses the segment ending there
+        #Outside the range the first or last segment is extended
+        segment = np.clip(np.searchsorted(adc_points, adc, side="left") - 1, 0, len(adc_points) - 2)
+        adc_low = adc_points[segment]
+        adc_high = adc_points[segment + 1]
+        newton_low = newton_points[segment]
+        newton_high = newton_points[segment + 1]
+
+        #Guard against identical ADC values at two calibration points
+        width = adc_high - adc_low
+        flat = width == 0
+        slope = (newton_high - newton_low) / np.where(flat, 1.0, width)
+        return np.where(flat, newton_low, newton_low + (adc - adc_low) * slope)
+
+    #Inverse conversion, Newtons back to (fractional) ADC values, for replaying exported force data
+    #Uses the same segments as _interpolate_array(), calibration force must rise with ADC
+    def newtons_to_adc_array(self, newton_values):
+        newtons = np.asarray(newton_values, dtype=np.float64)
+        if not self.is_calibrated or len(self.lookup_table) < 2:
+            return newtons.copy()
+        adc_points = np.array([pair[0] for pair in self.lookup_table], dtype=np.float64)
+        newton_points = np.array([pair[1] for pair in self.lookup_table], dtype=np.float64)
+
+        segment = np.clip(np.searchsorted(newton_points, newtons, side="left") - 1, 0, len(newton_points) - 2)
+        newton_low = newton_points[segment]
+        newton_high = newton_points[segment + 1]
+        adc_low = adc_points[segment]
+        adc_high = adc_points[segment + 1]
+
+        height = newton_high - newton_low
+        flat = height == 0
+        slope = (adc_high - adc_low) / np.where(flat, 1.0, height)
+        return np.where(flat, adc_low, adc_low + (newtons - newton_low) * slope)
+
+    #Precompute Newtons for every integer ADC code
+    def _build_code_table(self):
+        if len(self.lookup_table) < 2:
+            self.code_table = None
+            return
+        self.code_table = self._interpolate_array(np.arange(ADC_CODES, dtype=np.float64))
  
     #Find the two calibration points that bracket the given ADC value
     #Returns (adc_low, newton_low, adc_high, newton_high)
@@ -128,6 +205,7 @@ class PiecewiseLinearCalibration:
     def reset(self):
         self.lookup_table = []
         self.is_calibrated = False
+        self.code_table = None
 
     #Save lookup table and calibration date to JSON
     def save_to_file(self, file_path):
@@ -147,6 +225,7 @@ class PiecewiseLinearCalibration:
                 data = json.load(f)
             self.lookup_table = [tuple(pair) for pair in data["lookup_table"]]
             self.is_calibrated = len(self.lookup_table) >= 2
+            self._build_code_table()
 
             #Parse date if present — may be absent in older calibration files
             date_str = data.get("calibration_date", "")
@@ -0,0 +1,79 @@
+"""
+Pipeline Stats - Throughput and per-stage latency of the acquisition data path
+Each stage records how long it took per processed batch (a few perf_counter calls per batch,
+never per sample), so it stays on during normal acquisition at no measurable cost.
+
+Stages:
+    queue     - transport chunk waiting in the pipeline queue (oldest chunk of each batch)
+    decode    - bytes to ADC samples
+    calibrate - ADC to Newtons and zero offset
+    filter    - live causal filters
+    store     - torque, envelope and sample store update
+    session   - session file write
+    render    - plot update on the GUI thread
+"""
+
+import threading
+import time
+
+STAGES = ("queue", "decode", "calibrate", "filter", "store", "session", "render")
+PROCESSING_STAGES = ("decode", "calibrate", "filter", "store", "session")
+
+class PipelineStats:
+    def __init__(self):
+        self.lock = threading.Lock()    #stages are recorded from the worker and GUI threads
+        self.reset()
+
+    #Forget all measurements, call at the start of each trial
+    def reset(self):
+        with self.lock:
+            self.totals = dict.fromkeys(STAGES, 0.0)
+            self.maxima = dict.fromkeys(STAGES, 0.0)
+            self.counts = dict.fromkeys(STAGES, 0)
+            self.samples = 0
+            self.batches = 0
+            self.start_time = time.perf_counter()
+            self.last_time = None
+
+    #Add one duration in seconds for stage
+    def record(self, stage, seconds):
+        with self.lock:
+            self.totals[stage] += seconds
+            self.counts[stage] += 1
+            if seconds > self.maxima[stage]:
+                self.maxima[stage] = seconds
+
+    #Count a processed batch of samples
+    def add_batch(self, sample_count):
+        now = time.perf_counter()
+        with self.lock:
+            self.last_time = now
+            self.samples += sample_count
+            self.batches += 1
+
+    #Samples per second of processing time, how fast the pipeline could go
+    def processing_rate(self):
+        busy = sum(self.totals[stage] for stage in PROCESSING_STAGES)
+        return self.samples / busy if busy > 0 else 0.0
+
+    #Samples per second of wall time from reset to the last batch, how fast data actually came through
+    def wall_rate(self):
+        if self.last_time is None or self.last_time <= self.start_time:
+            return 0.0
+        return self.samples / (self.last_time - self.start_time)
+
+    #Multi-line summary for the console
+    def report(self):
+        with self.lock:
+            lines = [f"Pipeline: {self.samples} samples in {self.batches} batches, "
+                     f"{self.wall_rate():,.0f} samples/s received, {self.processing_rate():,.0f} samples/s processing capacity"]
+            for stage in STAGES:
+                count = self.counts[stage]
+                if count == 0:
+                    continue
+                mean_ms = self.totals[stage] / count * 1000.0
+                per_sample_us = self.totals[stage] / self.samples * 1e6 if self.samples and stage in PROCESSING_STAGES else None
+                per_sample = f", {per_sample_us:.2f} µs/sample" if per_sample_us is not None else ""
+                lines.append(f"    {stage:<9} mean {mean_ms:7.3f} ms  max {self.maxima[stage] * 1000.0:7.3f} ms  "
+                             f"x{count}{per_sample}")
+            return "\n".join(lines)
@@ -0,0 +1,106 @@
+"""
+Render Scheduler - Fixed rate GUI refresh decoupled from sample arrival
+Calls the render callback from a QTimer only when new data has been marked,
+measures how long each frame takes and backs off the frame rate when frames overrun
+"""
+
+import time
+from PyQt6.QtCore import QObject, QTimer, pyqtSignal
+
+class RenderScheduler(QObject):
+
+    #Define signals
+    frame_rendered = pyqtSignal(float)      #frame time in ms
+
+    #Initialize with render callback, target frame rate and lowest rate allowed when backing off
+    def __init__(self, render_callback, frame_rate=30, min_frame_rate=5):
+        super().__init__()
+        self.render_callback = render_callback
+        self.target_frame_rate = frame_rate
+        self.min_frame_rate = min_frame_rate
+        self.current_frame_rate = frame_rate
+
+        #Set when new data arrives, cleared when drawn
+        self.dirty = False
+
+        #Frame statistics
+        self.frame_time_ms = 0.0            #last frame
+        self.average_frame_time_ms = 0.0    #exponential moving average
+        self.frames_rendered = 0
+        self.frames_overrun = 0
+        self._fast_frames = 0               #consecutive frames well under budget
+
+        self.timer = QTimer(self)
+        self.timer.timeout.connect(self._on_tick)
+
+    #Start periodic refresh
+    def start(self):
+        self._apply_interval()
+        self.timer.start()
+
+    #Stop periodic refresh, draws pending data once so the last samples are shown
+    def stop(self):
+        self.timer.stop()
+        self.flush()
+
+    #Mark that new data is waiting to be drawn
+    def mark_dirty(self):
+        self.dirty = True
+
+    #Draw now if anything is pending
+    def flush(self):
+        if self.dirty:
+            self._render()
+
+    #Set target frame rate, resets back-off
+    def set_frame_rate(self, frame_rate):
+        self.target_frame_rate = max(frame_rate, self.min_frame_rate)
+        self.current_frame_rate = self.target_frame_rate
+        self._fast_frames = 0
+        self._apply_interval()
+
+    #Timer tick, skip if nothing changed since last frame
+    def _on_tick(self):
+        if not self.dirty:
+            return
+        self._render()
+        self._adjust_rate()
+
+    #Run render callback and time it
+    def _render(self):
+        self.dirty = False
+        frame_start = time.perf_counter()
+        self.render_callback()
+        self.frame_time_ms = (time.perf_counter() - frame_start) * 1000.0
+
+        self.frames_rendered += 1
+        if self.frames_rendered == 1:
+            self.average_frame_time_ms = self.frame_time_ms
+        else:
+            self.average_frame_time_ms += 0.1 * (self.frame_time_ms - self.average_frame_time_ms)
+        self.frame_rendered.emit(self.frame_time_ms)
+
+    #Halve the rate when a frame overruns its budget, step back up after a run of fast frames
+    def _adjust_rate(self):
+        budget_ms = 1000.0 / self.current_frame_rate
+
+        if self.frame_time_ms > budget_ms:
+            self.frames_overrun += 1
+            self._fast_frames = 0
+            if self.current_frame_rate > self.min_frame_rate:
+                self.current_frame_rate = max(self.min_frame_rate, self.current_frame_rate / 2.0)
+                self._apply_interval()
+            return
+
+        if self.current_frame_rate < self.target_frame_rate and self.frame_time_ms < budget_ms / 4.0:
+            self._fast_frames += 1
+            if self._fast_frames >= 10:
+                self._fast_frames = 0
+                self.current_frame_rate = min(self.target_frame_rate, self.current_frame_rate * 1.5)
+                self._apply_interval()
+        else:
+            self._fast_frames = 0
+
+    #Update timer interval from current frame rate
+    def _apply_interval(self):
+        self.timer.setInterval(max(1, int(round(1000.0 / self.current_frame_rate))))
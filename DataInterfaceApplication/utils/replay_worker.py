@@ -0,0 +1,213 @@
+"""
+Replay Worker - Plays a recorded trial back as if it came from the device
+Source is a session file (.lsmd, ADC values re-encoded as the firmware's "%u\\r\\n" lines),
+an exported CSV (torque converted back to ADC values through the calibration and the limb length
+stored in the export) or a raw capture of the serial stream. Bytes are emitted through data_received
+at the recorded sample rate (scaled by speed, 0 = as fast as possible), in the same kind of
+~15 ms chunks the USB and BLE workers deliver, so everything downstream runs unchanged.
+Exported torque is already filtered, so active filters apply a second time when a CSV is replayed
+(the dashboard badge says so).
+
+Like the device, it only streams between "start" and "stop" commands sent with send().
+Every "start" plays the recording from the beginning, so repeated trials see identical input.
+"ping <token>" is answered with a "pong <token>" line ahead of the next chunk, as the firmware does.
+"""
+
+import csv
+import os
+import threading
+import time
+import numpy as np
+from PyQt6.QtCore import QThread, pyqtSignal
+from utils.session_file import SessionReader, FILE_EXTENSION
+
+#Samples per chunk when replaying as fast as possible
+UNTHROTTLED_CHUNK = 4096
+
+#Sample rates accepted from CSV time stamps, anything else falls back to the given rate
+MIN_CSV_RATE = 1.0
+MAX_CSV_RATE = 100000.0
+CSV_LIMB_COLUMN = "Limb Length (cm)"
+
+#Limb length in m from the metadata columns of an exported CSV, None if not recorded
+def csv_limb_length(path):
+    with open(path, encoding="utf-8-sig", newline="") as f:
+        rows = csv.reader(f)
+        header = next(rows, [])
+        first = next(rows, [])
+    if CSV_LIMB_COLUMN not in header:
+        return None
+    position = header.index(CSV_LIMB_COLUMN)
+    try:
+        limb_length_m = float(first[position]) / 100.0
+    except (IndexError, ValueError):
+        return None
+    return limb_length_m if limb_length_m > 0 else None
+
+#Sample rate from CSV time stamps over the whole span, robust to rounded or repeated stamps
+#None if the stamps do not give a plausible rate
+def csv_sample_rate(times):
+    if len(times) < 2:
+        return None
+    span = times[-1] - times[0]
+    if not np.isfinite(span) or span <= 0:
+        return None
+    rate = (len(times) - 1) / span
+    if not MIN_CSV_RATE <= rate <= MAX_CSV_RATE:
+        return None
+    return int(round(rate))
+
+#Load replay source, returns (stream bytes, offset after each sample line, sample rate)
+#calibration, zero_offset and limb_length_m are only needed to turn CSV torque back into ADC values,
+#limb_length_m only if the CSV does not record its own
+def load_replay_source(path, sample_rate=1200, calibration=None, zero_offset=0.0, limb_length_m=0.50):
+    if path.lower().endswith(FILE_EXTENSION):
+        session = SessionReader(path)
+        adc = np.rint(session.samples["adc"]).astype(np.int64)
+        stream = (("%d\r\n" * len(adc)) % tuple(adc.tolist())).encode("ascii")
+        sample_rate = session.sample_rate
+    elif path.lower().endswith(".csv"):
+        #Time and torque columns of an exported trial, metadata columns are ignored
+        columns = np.loadtxt(path, delimiter=",", skiprows=1, usecols=(0, 1), encoding="utf-8-sig", ndmin=2)
+        limb_length_m = csv_limb_length(path) or limb_length_m
+        force = columns[:, 1] / limb_length_m + zero_offset
+        adc = calibration.newtons_to_adc_array(force) if calibration is not None else force
+        #Fractional ADC values keep the exported resolution, the decoder parses them like integers
+        stream = (("%.3f\r\n" * len(adc)) % tuple(adc.tolist())).encode("ascii")
+        sample_rate = csv_sample_rate(columns[:, 0]) or sample_rate
+    else:
+        with open(path, "rb") as f:
+            stream = f.read()
+
+    #Sample boundaries are line ends, chunks never split a line
+    line_ends = np.flatnonzero(np.frombuffer(stream, dtype=np.uint8) == 10) + 1
+    return stream, line_ends, sample_rate
+
+#Worker thread
+#Streams the replay source while started, same signals as the transport workers
+class ReplayWorker(QThread):
+    #Define signals
+    connected = pyqtSignal(bool)        #when source opens/fails
+    disconnected = pyqtSignal()         #when replay is closed
+    data_received = pyqtSignal(bytes)   #chunk of stream bytes
+    error = pyqtSignal(str)             #when error occurs
+    finished_source = pyqtSignal()      #end of recording reached without loop
+
+    #Initialize with source path, playback speed (1.0 = real time, 0 = unthrottled) and loop flag
+    #calibration, zero offset and limb length convert CSV torque back to ADC values
+    def __init__(self, path, speed=1.0, loop=False, chunk_interval=0.015, sample_rate=1200,
+                 calibration=None, zero_offset=0.0, limb_length_m=0.50):
+        super().__init__()
+        self.path = path
+        self.speed = speed
+        self.loop = loop
+        self.chunk_interval = chunk_interval    #seconds between chunks when throttled
+        self.sample_rate = sample_rate          #used for raw captures, sessions and CSV carry their own
+        self.calibration = calibration
+        self.zero_offset = zero_offset
+        self.limb_length_m = limb_length_m
+
+        self.running = False
+        self.streaming = False
+        self.rewind = False                     #set by "start", next chunk comes from the beginning
+        self.replies = []                       #pong lines to send ahead of the next chunk
+        self.wake = threading.Event()           #set on commands so run() reacts without waiting
+
+        #Statistics
+        self.samples_sent = 0
+        self.bytes_sent = 0
+
+    #Open source and stream it until disconnect()
+    def run(self):
+        try:
+            stream, line_ends, self.sample_rate = load_replay_source(self.path, self.sample_rate, self.calibration,
+                                                                     self.zero_offset, self.limb_length_m)
+        except (OSError, ValueError) as e:
+            self.error.emit(f"Could not open replay source: {str(e)}")
+            self.connected.emit(False)
+            return
+        if len(line_ends) == 0:
+            self.error.emit(f"No samples in {os.path.basename(self.path)}")
+            self.connected.emit(False)
+            return
+
+        self.running = True
+        self.connected.emit(True)
+        position = 0            #next sample to send
+        stream_start = None     #time and position streaming (re)started, for pacing
+
+        while self.running:
+            if not self.streaming:
+                stream_start = None
+                self.wake.wait(0.05)
+                self.wake.clear()
+                continue
+
+            if self.rewind:
+                self.rewind = False
+                position = 0
+                stream_start = None
+
+            #Samples due since streaming started, real time pacing avoids drift
+            now = time.perf_counter()
+            if stream_start is None:
+                stream_start = (now, position)
+            if self.speed > 0:
+                due = stream_start[1] + int((now - stream_start[0]) * self.sample_rate * self.speed)
+            else:
+                due = position + UNTHROTTLED_CHUNK
+            end = min(due, len(line_ends))
+
+            replies = b""
+            while self.replies:
+                replies += self.replies.pop(0)
+
+            if end > position or replies:
+                begin_byte = line_ends[position - 1] if position > 0 else 0
+                chunk = replies + stream[begin_byte:line_ends[end - 1]] if end > position else replies
+                self.samples_sent += end - position
+                self.bytes_sent += len(chunk)
+                position = end
+                self.data_received.emit(chunk)
+
+            #End of recording, wrap around or stop streaming
+            if position >= len(line_ends):
+                if self.loop:
+                    position = 0
+                    stream_start = None
+                else:
+                    self.streaming = False
+                    self.finished_source.emit()
+                    continue
+
+            if self.speed > 0:
+                self.wake.wait(self.chunk_interval)
+                self.wake.clear()
+
+        self.disconnected.emit()
+
+    #Open source and begin serving commands
+    def connect(self):
+        self.start()
+
+    #Device commands, "start" streams from the beginning, "stop" stops, others ignored
+    def send(self, data):
+        if isinstance(data, bytes):
+            data = data.decode("utf-8", errors="ignore")
+        command = data.strip().lower()
+        if command == "start":
+            self.rewind = True
+            self.streaming = True
+        elif command == "stop":
+            self.streaming = False
+        elif command == "ping" or command.startswith("ping "):
+            self.replies.append(f"\r\npong{command[4:]}\r\n".encode("ascii", errors="ignore"))
+        self.wake.set()
+        return True
+
+    #Stop replay, blocks until the thread exits
+    def disconnect(self):
+        self.running = False
+        self.streaming = False
+        self.wake.set()
+        self.wait()
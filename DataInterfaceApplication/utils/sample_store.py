@@ -0,0 +1,120 @@
+"""
+Sample Store - Columnar sample storage backed by preallocated NumPy arrays
+Replaces per-sample Python list/deque appends with block appends
+Views returned are zero-copy slices of the backing arrays, valid until the next append
+
+Two modes:
+    fixed    - memory is allocated once, oldest samples are dropped when full (ring behaviour)
+    growable - capacity doubles when full, for sessions without a known length
+"""
+
+import numpy as np
+
+class SampleStore:
+    #Initialize with capacity in samples and the column names to store
+    def __init__(self, capacity, columns=("time", "force", "raw_force"), dtype=np.float64, growable=False):
+        self.capacity = int(capacity)
+        self.columns = tuple(columns)
+        self.dtype = dtype
+        self.growable = growable
+
+        #Extra space past capacity so dropping old samples is a block move every slack samples, not every append
+        self.slack = 0 if growable else max(1, self.capacity // 4)
+        storage_length = self.capacity + self.slack
+        self.arrays = {name: np.empty(storage_length, dtype=dtype) for name in self.columns}
+
+        #Valid data lives in [start:end] of every backing array
+        self.start = 0
+        self.end = 0
+
+        #Absolute index of the first stored sample (increases as old samples are dropped)
+        self.first_index = 0
+
+    #Number of stored samples
+    def __len__(self):
+        return self.end - self.start
+
+    #Append a block of equal length arrays, one per column
+    def append(self, **blocks):
+        lengths = {len(values) for values in blocks.values()}
+        if len(lengths) != 1 or set(blocks) != set(self.columns):
+            raise ValueError("append() needs one equal length block per column")
+
+        count = lengths.pop()
+        if count == 0:
+            return
+
+        #Fixed mode never keeps more than capacity, only the newest part of an oversized block is stored
+        if not self.growable and count > self.capacity:
+            skipped = count - self.capacity
+            self.first_index += len(self) + skipped
+            self.start = self.end = 0
+            blocks = {name: values[skipped:] for name, values in blocks.items()}
+            count = self.capacity
+
+        if self.end + count > len(self.arrays[self.columns[0]]):
+            if self.growable:
+                self._grow(len(self) + count)
+            else:
+                self._compact(count)
+
+        for name, values in blocks.items():
+            self.arrays[name][self.end:self.end + count] = values
+        self.end += count
+
+        #Drop oldest samples beyond capacity
+        if not self.growable and len(self) > self.capacity:
+            dropped = len(self) - self.capacity
+            self.start += dropped
+            self.first_index += dropped
+
+    #Move the newest samples to the front so count more fit (fixed mode)
+    def _compact(self, count):
+        keep = min(len(self), self.capacity - count)
+        dropped = len(self) - keep
+        for array in self.arrays.values():
+            array[:keep] = array[self.end - keep:self.end]
+        self.first_index += dropped
+        self.start = 0
+        self.end = keep
+
+    #Double capacity until required samples fit (growable mode)
+    def _grow(self, required):
+        new_capacity = max(self.capacity, 1)
+        while new_capacity < required:
+            new_capacity *= 2
+
+        for name, array in self.arrays.items():
+            grown = np.empty(new_capacity, dtype=self.dtype)
+            grown[:len(self)] = array[self.start:self.end]
+            self.arrays[name] = grown
+
+        self.end = len(self)
+        self.start = 0
+        self.capacity = new_capacity
+
+    #Zero-copy view of a column
+    def view(self, name):
+        return self.arrays[name][self.start:self.end]
+
+    #Overwrite a whole column, used when filters are re-applied to the stored data
+    def set_column(self, name, values):
+        if len(values) != len(self):
+            raise ValueError("set_column() length must match stored sample count")
+        self.arrays[name][self.start:self.end] = values
+
+    #Last stored value of a column, None if empty
+    def last(self, name):
+        if len(self) == 0:
+            return None
+        return float(self.arrays[name][self.end - 1])
+
+    #Remove all samples, keeps allocated memory
+    def clear(self):
+        self.start = 0
+        self.end = 0
+        self.first_index = 0
+
+    #Memory allocated for all columns in bytes
+    def nbytes(self):
+        return sum(array.nbytes for array in self.arrays.values())
@@ -0,0 +1,67 @@
+"""
+Serial Reader - Adaptive USB serial reads into a preallocated buffer
+Each read takes everything the driver already holds (in_waiting) instead of a fixed chunk,
+so there is one read per wake-up rather than one per 256 bytes, and nothing waits for a
+chunk to fill. When the driver is empty it blocks for a single byte up to the port timeout.
+
+Reads land in one reusable bytearray and are returned as memoryview slices, valid until
+the next read. Callers copy what they keep (the transport batcher extends its buffer).
+"""
+
+import time
+
+class SerialReader:
+    #Initialize with open serial port and buffer size in bytes (largest single read)
+    def __init__(self, serial_port, buffer_size=65536):
+        self.serial_port = serial_port
+        self.buffer = bytearray(buffer_size)
+        self.view = memoryview(self.buffer)
+
+        #Statistics
+        self.reads = 0                  #reads that returned data
+        self.bytes_read = 0
+        self.largest_read = 0
+        self.read_latency_ms = 0.0      #time from wake-up (first byte) to bytes in buffer, moving average
+        self.bytes_per_second = 0.0     #over the last completed second
+        self._rate_start = time.perf_counter()
+        self._rate_bytes = 0
+
+    #Read whatever is available, returns memoryview of the bytes read or None on timeout
+    def read(self):
+        port = self.serial_port
+        size = len(self.buffer)
+
+        waiting = port.in_waiting
+        if waiting == 0:
+            #Nothing buffered, block for the first byte (returns 0 after port timeout)
+            if port.readinto(self.view[0:1]) == 0:
+                self._update_rate()
+                return None
+            count = 1
+            waiting = port.in_waiting
+        else:
+            count = 0
+
+        wake_time = time.perf_counter()
+        if waiting:
+            count += port.readinto(self.view[count:min(size, count + waiting)])
+        latency_ms = (time.perf_counter() - wake_time) * 1000.0
+
+        self.reads += 1
+        self.bytes_read += count
+        self.largest_read = max(self.largest_read, count)
+        if self.reads == 1:
+            self.read_latency_ms = latency_ms
+        else:
+            self.read_latency_ms += 0.1 * (latency_ms - self.read_latency_ms)
+        self._update_rate()
+        return self.view[:count]
+
+    #Roll bytes per second once a second has passed
+    def _update_rate(self):
+        now = time.perf_counter()
+        elapsed = now - self._rate_start
+        if elapsed >= 1.0:
+            self.bytes_per_second = (self.bytes_read - self._rate_bytes) / elapsed
+            self._rate_start = now
+            self._rate_bytes = self.bytes_read
@@ -0,0 +1,155 @@
+"""
+Session File - Binary trial recording written continuously during acquisition
+--------------------------------------------------------------------------------
+Layout of a .lsmd file:
+    bytes 0-7        magic b"LSMDSES1"
+    bytes 8-11       header JSON length (uint32, little endian)
+    bytes 12-4095    header JSON (UTF-8), padded with spaces to HEADER_SIZE
+    bytes 4096-      sample records, SAMPLE_DTYPE, appended as blocks arrive
+
+Header holds sample rate, calibration table and date, zero offset, limb length,
+firmware version and start/stop timestamps. It is fixed size, so it is rewritten
+in place when the trial stops without moving the samples.
+
+The sample section needs no parsing: SessionReader maps it with np.memmap.
+The record count comes from the file size, so a session cut short by a crash
+or power loss still opens with every record that reached the disk.
+
+Usage:
+    writer = SessionWriter(path, sample_rate=1200, zero_offset=0.0, limb_length_m=0.5)
+    writer.append(index, adc, force)
+    writer.close()
+
+    session = SessionReader(path)
+    session.header["sample_rate"], session.samples["force"]
+"""
+
+import json
+import os
+import struct
+import threading
+import time
+from datetime import datetime
+import numpy as np
+
+MAGIC = b"LSMDSES1"
+HEADER_SIZE = 4096
+FORMAT_VERSION = 1
+FILE_EXTENSION = ".lsmd"
+
+#One record per sample: index since start of trial, raw ADC value, calibrated zero corrected force (N, unfiltered)
+SAMPLE_DTYPE = np.dtype([("index", "<u8"), ("adc", "<f4"), ("force", "<f8")])
+
+#Pack header dict into exactly HEADER_SIZE bytes
+def _pack_header(header):
+    text = json.dumps(header).encode("utf-8")
+    if len(text) > HEADER_SIZE - 12:
+        raise ValueError("Session header too large")
+    return MAGIC + struct.pack("<I", len(text)) + text + b" " * (HEADER_SIZE - 12 - len(text))
+
+#Default file path for a new session in directory, named by start time to the millisecond plus suffix
+#A counter is added if that name is taken, SessionWriter opens with "xb" so an existing file is never overwritten
+def new_session_path(directory, suffix=""):
+    os.makedirs(directory, exist_ok=True)
+    stem = os.path.join(directory, datetime.now().strftime("session_%Y%m%d_%H%M%S_%f")[:-3] + suffix)
+    path = stem + FILE_EXTENSION
+    counter = 2
+    while os.path.exists(path):
+        path = f"{stem}_{counter}{FILE_EXTENSION}"
+        counter += 1
+    return path
+
+class SessionWriter:
+    #Create file and write header, calibration is a PiecewiseLinearCalibration or None
+    def __init__(self, path, sample_rate, calibration=None, zero_offset=0.0, limb_length_m=None,
+                 firmware_version=None, flush_interval=0.5):
+        self.path = path
+        self.flush_interval = flush_interval    #seconds between flushes to disk
+        self.sample_count = 0
+        self._last_flush = time.monotonic()
+
+        #Held by the pipeline worker across a whole append, close waits for it
+        self.lock = threading.RLock()
+
+        calibrated = calibration is not None and calibration.is_calibrated
+        self.header = {
+            "format_version": FORMAT_VERSION,
+            "sample_rate": sample_rate,
+            "calibration_table": [list(pair) for pair in calibration.lookup_table] if calibrated else [],
+            "calibration_date": calibration.calibration_date.isoformat() if calibrated and calibration.calibration_date else None,
+            "zero_offset": zero_offset,
+            "limb_length_m": limb_length_m,
+            "firmware_version": firmware_version,
+            "started": datetime.now().isoformat(timespec="milliseconds"),
+            "stopped": None,
+            "sample_count": None,       #set on close, readers fall back to file size
+            "record_dtype": SAMPLE_DTYPE.descr,
+        }
+
+        self.file = open(path, "xb")     #FileExistsError (an OSError) rather than overwrite a trial
+        self.file.write(_pack_header(self.header))
+        self.file.flush()
+
+    #Append a block of samples, arrays of equal length
+    def append(self, index, adc, force):
+        count = len(index)
+        with self.lock:
+            if count == 0 or self.file is None:
+                return
+            records = np.empty(count, dtype=SAMPLE_DTYPE)
+            records["index"] = index
+            records["adc"] = adc
+            records["force"] = force
+            self.file.write(records.tobytes())
+            self.sample_count += count
+
+            #Flush periodically so data reaches the disk during long trials
+            now = time.monotonic()
+            if now - self._last_flush >= self.flush_interval:
+                self.file.flush()
+                self._last_flush = now
+
+    #Finish session, rewrites header with stop time and sample count
+    #Waits for an append in progress on another thread
+    def close(self):
+        with self.lock:
+            if self.file is None:
+                return
+            self.header["stopped"] = datetime.now().isoformat(timespec="milliseconds")
+            self.header["sample_count"] = self.sample_count
+            self.file.flush()
+            self.file.seek(0)
+            self.file.write(_pack_header(self.header))
+            self.file.close()
+            self.file = None
+
+class SessionReader:
+    #Open session file, samples are memory mapped (read only)
+    def __init__(self, path):
+        self.path = path
+        with open(path, "rb") as f:
+            prefix = f.read(12)
+            if len(prefix) < 12 or prefix[:8] != MAGIC:
+                raise ValueError(f"Not an LSMD session file: {path}")
+            (length,) = struct.unpack("<I", prefix[8:12])
+            self.header = json.loads(f.read(length).decode("utf-8"))
+
+        #Whole records on disk, partial trailing record from an interrupted write is ignored
+        count = (os.path.getsize(path) - HEADER_SIZE) // SAMPLE_DTYPE.itemsize
+        if count > 0:
+            self.samples = np.memmap(path, dtype=SAMPLE_DTYPE, mode="r", offset=HEADER_SIZE, shape=(count,))
+        else:
+            self.samples = np.empty(0, dtype=SAMPLE_DTYPE)
+
+    #Number of samples
+    def __len__(self):
+        return len(self.samples)
+
+    #Sample rate in Hz
+    @property
+    def sample_rate(self):
+        return self.header["sample_rate"]
+
+    #Time of each sample in seconds, from its index
+    def times(self):
+        return self.samples["index"] / float(self.sample_rate)
@@ -0,0 +1,113 @@
+"""
+Spectrum Analyzer - Welch power spectrum of the newest samples, updated incrementally at the GUI frame rate
+Segments of FFT_SIZE samples start every hop samples of the stream (50 % overlap) and are windowed with a
+precomputed Hann window. Each segment's power spectrum is computed once, when the segment is complete,
+and kept in a ring of the newest SEGMENTS spectra, the displayed spectrum is their mean. A frame therefore
+costs at most SEGMENTS FFTs (usually none or one), however long the trial is.
+
+Frequency resolution is sample_rate / FFT_SIZE (1.2 Hz at 1200 Hz), averaged over about
+(SEGMENTS + 1) * FFT_SIZE / 2 samples (3.8 s at 1200 Hz).
+"""
+
+import numpy as np
+
+FFT_SIZE = 1024
+SEGMENTS = 8
+MIN_DB = -120.0     #floor for empty bins on a log scale
+
+class SpectrumAnalyzer:
+    #Initialize with sample rate in Hz, FFT length and number of segments averaged
+    def __init__(self, sample_rate, fft_size=FFT_SIZE, segments=SEGMENTS):
+        self.sample_rate = sample_rate
+        self.fft_size = fft_size
+        self.segments = segments
+        self.hop = fft_size // 2
+
+        #Precomputed once: window, one-sided PSD scaling and bin frequencies
+        self.window = np.hanning(fft_size)
+        self.scale = np.full(fft_size // 2 + 1, 2.0 / (sample_rate * np.sum(self.window ** 2)))
+        self.scale[0] /= 2.0
+        if fft_size % 2 == 0:
+            self.scale[-1] /= 2.0
+        self.frequencies = np.fft.rfftfreq(fft_size, 1.0 / sample_rate)
+
+        #Reused buffers: windowed segment, ring of segment spectra, output
+        self._segment = np.empty(fft_size)
+        self._spectra = np.empty((segments, len(self.frequencies)))
+        self.psd = np.zeros(len(self.frequencies))      #power spectral density, units² / Hz
+        self.psd_db = np.full(len(self.frequencies), MIN_DB)
+        self.reset()
+
+    #Forget all segments, the next update starts from the newest stored samples
+    def reset(self):
+        self.next_start = None      #absolute sample index of the next segment to compute
+        self.filled = 0             #segments in the ring
+        self.slot = 0               #ring position of the next segment
+
+    #Absolute index of the first sample the next update reads, given stored samples first_index to end
+    #Lets callers copy just that tail under their lock and run update on the copy outside it
+    def tail_start(self, first_index, end):
+        self._advance(first_index, end)
+        return min(self.next_start, end)
+
+    #Compute every newly completed segment of values, whose first element is absolute sample first_index
+    #Returns True if the spectrum changed
+    def update(self, values, first_index):
+        end = first_index + len(values)
+        self._advance(first_index, end)
+
+        changed = False
+        while self.next_start + self.fft_size <= end:
+            offset = self.next_start - first_index
+            self._add_segment(values[offset:offset + self.fft_size])
+            self.next_start += self.hop
+            changed = True
+
+        if changed:
+            np.mean(self._spectra[:self.filled], axis=0, out=self.psd)
+            self.psd *= self.scale
+            np.log10(np.maximum(self.psd, 10.0 ** (MIN_DB / 10.0)), out=self.psd_db)
+            self.psd_db *= 10.0
+        return changed
+
+    #Move next_start onto the stored samples first_index to end, skipping segments the ring would not keep
+    def _advance(self, first_index, end):
+        if self.next_start is None or self.next_start < first_index or self.next_start > end:
+            #Start (or restart after samples were dropped or cleared) at the newest full set of segments
+            self.reset()
+            start = max(first_index, end - self.fft_size - (self.segments - 1) * self.hop)
+            self.next_start = start - start % self.hop
+            if self.next_start < first_index:
+                self.next_start += self.hop
+
+        #Falling behind by more than the ring holds, skip to the segments that will be kept
+        newest = end - self.fft_size
+        if newest - self.next_start > (self.segments - 1) * self.hop:
+            skip = (newest - self.next_start) // self.hop - (self.segments - 1)
+            self.next_start += skip * self.hop
+
+    #Power of one segment into the ring, mean removed so the static load does not swamp the low bins
+    def _add_segment(self, samples):
+        np.subtract(samples, samples.mean(), out=self._segment)
+        self._segment *= self.window
+        spectrum = np.fft.rfft(self._segment)
+        power = self._spectra[self.slot]
+        np.multiply(spectrum.real, spectrum.real, out=power)
+        power += spectrum.imag * spectrum.imag
+
+        self.slot = (self.slot + 1) % self.segments
+        self.filled = min(self.filled + 1, self.segments)
+
+    #True once at least one segment has been computed
+    def ready(self):
+        return self.filled > 0
+
+    #Frequency of the strongest bin between low and high Hz, None before the first segment
+    def peak_frequency(self, low=1.0, high=None):
+        if not self.ready():
+            return None
+        high = self.sample_rate / 2.0 if high is None else high
+        band = np.flatnonzero((self.frequencies >= low) & (self.frequencies <= high))
+        if len(band) == 0:
+            return None
+        return float(self.frequencies[band[np.argmax(self.psd[band])]])
@@ -0,0 +1,273 @@
+"""
+Stream Decoder - Converts raw byte chunks from the device into NumPy sample arrays
+Parses whole chunks at once instead of one line at a time
+Keeps incomplete lines/frames between calls so chunk boundaries never lose samples
+After each decode, indices holds the true sample index of every returned sample (0 = first sample
+since reset). Binary frames unwrap their sequence numbers so lost frames leave holes in the indices,
+ASCII lines carry no sequence and are numbered consecutively.
+Frames have no checksum, so a sequence step is only counted as loss when it is plausible: repeated
+or backward frames are dropped as duplicates, a step over MAX_SEQ_GAP or a gap the next frame does not
+continue from is treated as a corrupted sequence number (frame dropped, or resync if the stream restarted).
+Latency probe replies ("pong <token>" lines, ASCII only) are taken out of the sample stream and
+listed in pongs as (token, index of the next sample) for the last decode.
+
+Supported formats:
+    ascii  - legacy firmware output, one ADC value per line ("512\\r\\n")
+    binary - fixed 6 byte frames, little endian:
+                 sync  uint16  0x5AA5 (bytes A5 5A)
+                 seq   uint16  sample sequence number, wraps at 65536
+                 adc   uint16  raw ADC code
+"""
+
+import numpy as np
+
+#Binary frame layout
+FRAME_SYNC = 0x5AA5
+FRAME_SYNC_BYTES = b"\xA5\x5A"
+FRAME_DTYPE = np.dtype([("sync", "<u2"), ("seq", "<u2"), ("adc", "<u2")])
+FRAME_SIZE = FRAME_DTYPE.itemsize
+SEQ_MODULUS = 1 << 16
+MAX_SEQ_GAP = 1024      #frames, more than the device and transport buffers hold, larger steps are not loss
+
+class StreamDecoder:
+    FORMAT_ASCII = "ascii"
+    FORMAT_BINARY = "binary"
+
+    #Initialize with stream format and accepted ADC range (10 bit by default)
+    def __init__(self, frame_format=FORMAT_ASCII, adc_min=0, adc_max=1023):
+        if frame_format not in (self.FORMAT_ASCII, self.FORMAT_BINARY):
+            raise ValueError(f"Unknown stream format: {frame_format}")
+
+        self.frame_format = frame_format
+        self.adc_min = adc_min
+        self.adc_max = adc_max
+
+        #Bytes carried over to the next call (partial line or frame)
+        self.pending = bytearray()
+
+        #True sample index of each sample returned by the last decode, and of the last sample so far
+        self.indices = np.empty(0, dtype=np.int64)
+        self.last_index = -1
+        self.last_seq = None
+        self.pongs = []
+
+        #Counters for diagnostics
+        self.samples_decoded = 0
+        self.samples_rejected = 0
+        self.samples_lost = 0       #sequence numbers skipped (binary only)
+        self.frames_dropped = 0     #duplicate, backward or corrupted sequence numbers (binary only)
+        self.resyncs = 0            #sequence restarted, continued without counting loss
+        self.bytes_discarded = 0
+        self._resync_seq = None     #sequence number of the last implausible frame, a restart if the next follows it
+
+    #Decode a chunk of bytes, returns float64 array of ADC samples (may be empty)
+    def decode(self, data):
+        if data:
+            self.pending += data
+
+        pong_offsets = []
+        if self.frame_format == self.FORMAT_BINARY:
+            samples, seq = self._decode_binary()
+        else:
+            samples, seq = self._decode_ascii(pong_offsets), None
+
+        #Reject values outside of expected ADC range (also drops NaN)
+        #Done before unwrapping so a rejected frame is dropped with its sequence number, implausible
+        #sequence numbers themselves are caught in _unwrap
+        in_range = (samples >= self.adc_min) & (samples <= self.adc_max)
+        if not in_range.all():
+            self.samples_rejected += int(np.count_nonzero(~in_range))
+            samples = samples[in_range]
+            if seq is not None:
+                seq = seq[in_range]
+            pong_offsets = [(token, int(np.count_nonzero(in_range[:offset]))) for token, offset in pong_offsets]
+
+        if seq is not None:
+            self.indices, keep = self._unwrap(seq)
+            if keep is not None:
+                samples = samples[keep]
+        else:
+            self.indices = np.arange(self.last_index + 1, self.last_index + 1 + len(samples), dtype=np.int64)
+        #Pongs only come in ASCII streams, where indices are consecutive
+        self.pongs = [(token, self.last_index + 1 + offset) for token, offset in pong_offsets]
+        if len(samples):
+            self.last_index = int(self.indices[-1])
+
+        self.samples_decoded += len(samples)
+        return samples
+
+    #Sequence numbers to true sample indices, each step is 1 plus the frames lost in between
+    #Returns (indices of kept frames, mask of kept frames or None if all kept)
+    def _unwrap(self, seq):
+        if len(seq) == 0:
+            return np.empty(0, dtype=np.int64), None
+        seq = seq.astype(np.int64)
+        previous = seq[0] - 1 if self.last_seq is None else self.last_seq
+        steps = np.diff(seq, prepend=previous) % SEQ_MODULUS
+
+        #Usual case: every step moves forward, no gaps or only plausible ones confirmed by the next frame
+        forward = (steps >= 1) & (steps <= MAX_SEQ_GAP + 1)
+        if forward.all() and (steps[:-1] == 1).all() and self._resync_seq is None:
+            self.last_seq = int(seq[-1])
+            self.samples_lost += int(steps.sum()) - len(seq)
+            return self.last_index + np.cumsum(steps), None
+        return self._unwrap_checked(seq)
+
+    #Frame by frame unwrap for chunks with duplicates, gaps or implausible steps
+    def _unwrap_checked(self, seq):
+        keep = np.ones(len(seq), dtype=bool)
+        indices = []
+        index = self.last_index
+        last = self.last_seq
+        for position, value in enumerate(seq.tolist()):
+            step = 1 if last is None else (value - last) % SEQ_MODULUS
+            if step == 0:
+                #Repeat of the previous frame
+                keep[position] = False
+                self.frames_dropped += 1
+                continue
+
+            if step > MAX_SEQ_GAP + 1:
+                #Backward or far jump: a restart if the frame continues from the last implausible one
+                restart = self._resync_seq is not None and 1 <= (value - self._resync_seq) % SEQ_MODULUS <= 2
+                if not restart:
+                    keep[position] = False
+                    self.frames_dropped += 1
+                    self._resync_seq = value
+                    continue
+                self.resyncs += 1
+                step = 1
+            elif step > 1 and position + 1 < len(seq):
+                #Gap the next frame does not continue from, this frame's sequence number is corrupted
+                next_step = (seq[position + 1] - last) % SEQ_MODULUS
+                if 1 <= next_step < step:
+                    keep[position] = False
+                    self.frames_dropped += 1
+                    continue
+
+            self._resync_seq = None
+            self.samples_lost += step - 1
+            index += step
+            last = value
+            indices.append(index)
+
+        self.last_seq = last
+        return np.array(indices, dtype=np.int64), keep
+
+    #Parse every complete line in the pending buffer in one pass
+    #Probe replies found are added to pong_offsets as (token, number of samples before it)
+    def _decode_ascii(self, pong_offsets):
+        end = self.pending.rfind(b"\n")
+        if end < 0:
+            return np.empty(0, dtype=np.float64)
+
+        complete = bytes(self.pending[:end + 1])
+        del self.pending[:end + 1]
+        if b"pong" in complete:
+            return self._split_pongs(complete, pong_offsets)
+
+        #Whitespace split also strips \r and skips blank lines
+        tokens = complete.split()
+        if not tokens:
+            return np.empty(0, dtype=np.float64)
+
+        try:
+            return np.array(tokens, dtype=np.float64)
+        except ValueError:
+            #Chunk contains non numeric lines (status/debug text), fall back to per token parse
+            return self._parse_tokens(tokens)
+
+    #Slow path, only used for chunks that contain text responses
+    def _parse_tokens(self, tokens):
+        values = []
+        for token in tokens:
+            try:
+                values.append(float(token))
+            except ValueError:
+                self.bytes_discarded += len(token)
+        return np.array(values, dtype=np.float64)
+
+    #Slow path for chunks holding probe replies, parsed line by line so the token is not read as a sample
+    def _split_pongs(self, complete, pong_offsets):
+        values = []
+        for line in complete.split(b"\n"):
+            fields = line.split()
+            if fields and fields[0] == b"pong":
+                token = fields[1].decode("ascii", errors="ignore") if len(fields) > 1 else ""
+                pong_offsets.append((token, len(values)))
+            elif fields:
+                values.extend(self._parse_tokens(fields))
+        return np.array(values, dtype=np.float64)
+
+    #Parse every complete frame in the pending buffer, resyncing on corrupted data
+    #Returns (ADC values, sequence numbers)
+    def _decode_binary(self):
+        #Work on an immutable copy so no NumPy view pins the bytearray while it is trimmed
+        buffer = bytes(self.pending)
+        blocks = []
+        offset = 0
+
+        while True:
+            sync = buffer.find(FRAME_SYNC_BYTES, offset)
+            if sync < 0:
+                #Keep a trailing first sync byte in case the rest of the header arrives next call
+                keep = 1 if buffer.endswith(FRAME_SYNC_BYTES[:1]) else 0
+                end = max(offset, len(buffer) - keep)
+                self.bytes_discarded += end - offset
+                offset = end
+                break
+
+            self.bytes_discarded += sync - offset
+            offset = sync
+
+            frame_count = (len(buffer) - offset) // FRAME_SIZE
+            if frame_count == 0:
+                break
+
+            frames = np.frombuffer(buffer, dtype=FRAME_DTYPE, count=frame_count, offset=offset)
+            bad = np.flatnonzero(frames["sync"] != FRAME_SYNC)
+
+            #All frames aligned, take the whole run
+            if len(bad) == 0:
+                blocks.append(frames)
+                offset += frame_count * FRAME_SIZE
+                continue
+
+            #Keep the good run before the first bad frame, then resync one byte past it
+            good_count = int(bad[0])
+            if good_count:
+                blocks.append(frames[:good_count])
+            offset += good_count * FRAME_SIZE + 1
+            self.bytes_discarded += 1
+
+        #Drop consumed bytes, keep any partial frame
+        del self.pending[:offset]
+
+        if not blocks:
+            return np.empty(0, dtype=np.float64), np.empty(0, dtype=np.int64)
+        frames = np.concatenate(blocks) if len(blocks) > 1 else blocks[0]
+        return frames["adc"].astype(np.float64), frames["seq"]
+
+    #Clear partial data and counters, call at start of each acquisition
+    def reset(self):
+        self.pending.clear()
+        self.indices = np.empty(0, dtype=np.int64)
+        self.last_index = -1
+        self.last_seq = None
+        self.pongs = []
+        self.samples_decoded = 0
+        self.samples_rejected = 0
+        self.samples_lost = 0
+        self.frames_dropped = 0
+        self.resyncs = 0
+        self.bytes_discarded = 0
+        self._resync_seq = None
+
+    #Set stream format, clears partial data
+    def set_format(self, frame_format):
+        if frame_format not in (self.FORMAT_ASCII, self.FORMAT_BINARY):
+            raise ValueError(f"Unknown stream format: {frame_format}")
+        self.frame_format = frame_format
+        self.pending.clear()
+        self.last_seq = None
+        self._resync_seq = None
@@ -0,0 +1,78 @@
+"""
+Stream Monitor - Inter-arrival statistics of transport chunks, for streams without sequence numbers
+ASCII samples carry no index, so lost bytes cannot be located exactly. Instead the arrival time of
+every chunk (stamped by the transport thread on submit) is compared with the nominal sample rate:
+    stalls    - no data for longer than STALL_THRESHOLD, marked on the plot at the sample where it happened
+    shortfall - samples the device should have sent since the first chunk minus samples received,
+                an estimate (device clock tolerance shows up here too), reported after each trial
+Binary streams get exact loss counts from the decoder instead, see stream_decoder.py.
+"""
+
+import threading
+
+STALL_THRESHOLD = 0.25      #seconds without a chunk that count as a stall (USB chunks every ~15 ms, BLE ≤ 50 ms)
+MIN_SHORTFALL_SPAN = 1.0    #seconds of arrivals needed before the shortfall is reported
+
+class StreamMonitor:
+    #Initialize with nominal sample rate in Hz
+    def __init__(self, sample_rate):
+        self.sample_rate = sample_rate
+        self.lock = threading.Lock()    #written by the worker, read by the GUI
+        self.reset()
+
+    #Forget everything, call at the start of each trial
+    def reset(self):
+        with self.lock:
+            self.first_arrival = None
+            self.last_arrival = None
+            self.first_samples = 0      #samples in the first batch, they arrived at first_arrival
+            self.samples_received = 0
+            self.chunks = 0
+            self.max_interval = 0.0
+            self.stalls = []            #(trial time in s, seconds without data)
+
+    #Record arrival times of the chunks of one batch and the samples it held
+    #time_at is the trial time of the first sample of the batch, where a stall before it is marked
+    def record(self, arrivals, sample_count, time_at):
+        with self.lock:
+            for arrival in arrivals:
+                if self.last_arrival is not None:
+                    interval = arrival - self.last_arrival
+                    if interval > self.max_interval:
+                        self.max_interval = interval
+                    if interval > STALL_THRESHOLD:
+                        self.stalls.append((time_at, interval))
+                else:
+                    self.first_arrival = arrival
+                    self.first_samples = sample_count
+                self.last_arrival = arrival
+            self.chunks += len(arrivals)
+            self.samples_received += sample_count
+
+    #Samples expected at the nominal rate since the first chunk minus samples received after it
+    def shortfall(self):
+        if self.first_arrival is None:
+            return 0
+        expected = (self.last_arrival - self.first_arrival) * self.sample_rate
+        return int(round(expected - (self.samples_received - self.first_samples)))
+
+    #Stalls recorded after the first count, copied
+    def stalls_since(self, count):
+        with self.lock:
+            return self.stalls[count:]
+
+    #One line summary for the console
+    def report(self):
+        with self.lock:
+            if self.chunks < 2:
+                return "Arrival: not enough chunks"
+            elapsed = self.last_arrival - self.first_arrival
+            mean_ms = elapsed / (self.chunks - 1) * 1000.0
+            summary = (f"Arrival: {self.chunks} chunks, mean interval {mean_ms:.1f} ms, max {self.max_interval * 1000.0:.1f} ms, "
+                       f"{len(self.stalls)} stalls > {STALL_THRESHOLD * 1000.0:.0f} ms")
+            #Too short to compare against the nominal rate (or replayed faster than real time)
+            if elapsed < MIN_SHORTFALL_SPAN:
+                return summary
+            shortfall = self.shortfall()
+            percent = shortfall / (elapsed * self.sample_rate) * 100.0
+            return f"{summary}, shortfall ~{shortfall} samples ({percent:+.2f}% of nominal rate)"
@@ -0,0 +1,136 @@
+"""
+Torque Analysis - Contraction onset and rate of torque development from the sample arrays
+All searches are vectorized over the stored time/torque arrays: sample lookup by time uses
+np.searchsorted, onset is the first sustained crossing of a threshold over baseline noise,
+and RTD is reported over the standard 0-50/100/200 ms windows from onset with a peak-slope search.
+
+Usage:
+    result = analyze_trial(time_array, torque_array)
+    result.onset_time, result.rtd_windows[0.1], result.peak_slope
+"""
+
+import numpy as np
+
+RTD_WINDOWS = (0.05, 0.10, 0.20)    #seconds from onset
+
+#Onset detection settings
+BASELINE_DURATION = 0.2     #seconds of quiet signal used for baseline mean and noise
+THRESHOLD_SD = 3.0          #onset threshold, baseline standard deviations above mean
+MIN_RISE = 0.5              #N·m, lower bound of threshold above baseline for very clean signals
+SUSTAIN_DURATION = 0.02     #seconds torque must stay above threshold, rejects single-sample spikes
+
+SLOPE_WINDOW = 0.02         #seconds, span of each slope in the peak-slope search
+
+#Analysis result of one trial, times in seconds, rates in N·m/s, None where not available
+class TorqueAnalysis:
+    def __init__(self):
+        self.onset_index = None
+        self.onset_time = None
+        self.baseline = None            #mean torque before onset
+        self.threshold = None           #torque level that marked onset
+        self.peak_torque = None
+        self.peak_time = None
+        self.rtd_windows = {}           #window length -> RTD from onset
+        self.peak_slope = None          #steepest rise over SLOPE_WINDOW
+        self.peak_slope_time = None     #centre of the steepest window
+
+#Index of sample nearest to each time in target, times must be ascending
+def nearest_index(times, target):
+    times = np.asarray(times)
+    right = np.clip(np.searchsorted(times, target, side="left"), 1, max(len(times) - 1, 1))
+    left = right - 1
+    nearest = np.where(np.abs(times[right] - target) < np.abs(target - times[left]), right, left)
+    return int(nearest) if np.ndim(nearest) == 0 else nearest
+
+#Average rate between the samples nearest start_time and end_time, None if they are the same sample
+def rate_between(times, torque, start_time, end_time):
+    if len(times) < 2 or end_time <= start_time:
+        return None
+    start_index, end_index = nearest_index(times, np.array([start_time, end_time]))
+    delta_time = times[end_index] - times[start_index]
+    if start_index == end_index or delta_time == 0:
+        return None
+    return float((torque[end_index] - torque[start_index]) / delta_time)
+
+#Number of samples spanning duration at the trial's sample spacing, at least 1
+def _samples_for(times, duration):
+    if len(times) < 2:
+        return 1
+    spacing = (times[-1] - times[0]) / (len(times) - 1)
+    return max(1, int(round(duration / spacing))) if spacing > 0 else 1
+
+#Mean and standard deviation of the quietest BASELINE_DURATION window before index stop
+#Only windows in the lower half between resting level and peak count, so a plateau is never the baseline
+#Rolling statistics come from cumulative sums, one pass however long the trial
+def baseline_stats(times, torque, stop):
+    window = min(_samples_for(times, BASELINE_DURATION), max(stop, 1))
+    segment = torque[:max(stop, window)]
+    sums = np.concatenate(([0.0], np.cumsum(segment)))
+    squares = np.concatenate(([0.0], np.cumsum(segment * segment)))
+    means = (sums[window:] - sums[:-window]) / window
+    variances = np.maximum((squares[window:] - squares[:-window]) / window - means * means, 0.0)
+
+    lowest = means.min()
+    resting = means <= lowest + 0.5 * (torque[stop] - lowest)
+    quietest = int(np.argmin(np.where(resting, variances, np.inf)))
+    return float(means[quietest]), float(np.sqrt(variances[quietest]))
+
+#Index of contraction onset, first sample that starts a sustained run above threshold, None if not found
+def detect_onset(times, torque, threshold):
+    above = torque > threshold
+    sustain = min(_samples_for(times, SUSTAIN_DURATION), len(torque))
+
+    #Runs of sustain samples all above threshold, from the windowed count of above samples
+    counts = np.concatenate(([0], np.cumsum(above)))
+    sustained = np.flatnonzero(counts[sustain:] - counts[:-sustain] == sustain)
+    if len(sustained) == 0:
+        return None
+    return int(sustained[0])
+
+#RTD from onset over each window, None if the trial ends before the window does
+def window_rates(times, torque, onset_index, windows=RTD_WINDOWS):
+    onset_time = times[onset_index]
+    ends = np.searchsorted(times, onset_time + np.asarray(windows) - 1e-9, side="left")
+    rates = {}
+    for window, end in zip(windows, ends):
+        rates[window] = float((torque[end] - torque[onset_index]) / (times[end] - onset_time)) if end < len(times) else None
+    return rates
+
+#Steepest rise over SLOPE_WINDOW between start and stop indices, returns (slope, time) or (None, None)
+def peak_slope(times, torque, start, stop):
+    span = _samples_for(times, SLOPE_WINDOW)
+    segment_t = times[start:stop + 1]
+    segment_y = torque[start:stop + 1]
+    if len(segment_t) <= span:
+        return None, None
+    slopes = (segment_y[span:] - segment_y[:-span]) / (segment_t[span:] - segment_t[:-span])
+    best = int(np.argmax(slopes))
+    return float(slopes[best]), float((segment_t[best] + segment_t[best + span]) / 2)
+
+#Full analysis of one trial, torque in N·m
+def analyze_trial(times, torque):
+    times = np.asarray(times, dtype=np.float64)
+    torque = np.asarray(torque, dtype=np.float64)
+    result = TorqueAnalysis()
+    if len(times) < 2:
+        return result
+
+    peak_index = int(np.argmax(torque))
+    result.peak_torque = float(torque[peak_index])
+    result.peak_time = float(times[peak_index])
+
+    #Baseline from the signal before the peak, onset is searched in that range too
+    result.baseline, noise = baseline_stats(times, torque, peak_index)
+    result.threshold = result.baseline + max(THRESHOLD_SD * noise, MIN_RISE)
+    onset = detect_onset(times[:peak_index + 1], torque[:peak_index + 1], result.threshold)
+    if onset is None:
+        return result
+
+    result.onset_index = onset
+    result.onset_time = float(times[onset])
+    result.rtd_windows = window_rates(times, torque, onset)
+
+    #Steepest rise within the longest RTD window, or up to the peak if that comes first
+    slope_stop = min(int(np.searchsorted(times, result.onset_time + RTD_WINDOWS[-1])), len(times) - 1)
+    result.peak_slope, result.peak_slope_time = peak_slope(times, torque, onset, min(slope_stop, peak_index))
+    return result
@@ -0,0 +1,108 @@
+"""
+Transport Batcher - Coalesces transport reads/notifications into fewer, larger deliveries
+Bytes from each serial read or BLE notification are added to a shared buffer and handed on
+once the oldest pending byte is interval seconds old or max_bytes are waiting, so downstream
+signal/queue overhead is paid tens of times a second instead of once per notification
+"""
+
+import threading
+import time
+
+class TransportBatcher:
+    #Initialize with delivery callback (takes bytes), max hold time in seconds and byte threshold
+    def __init__(self, deliver, interval=0.015, max_bytes=4096):
+        self.deliver = deliver
+        self.interval = interval
+        self.max_bytes = max_bytes
+
+        self.buffer = bytearray()
+        self.lock = threading.Lock()
+        self.first_pending_time = None      #arrival of oldest byte in buffer
+
+        #Counters, totals and per second rates over the last completed second
+        self.chunks_in = 0                  #reads/notifications added
+        self.events_out = 0                 #deliveries made
+        self.bytes_in = 0
+        self.chunks_per_second = 0.0
+        self.events_per_second = 0.0
+        self.bytes_per_second = 0.0
+        self._rate_start = time.perf_counter()
+        self._rate_counts = (0, 0, 0)
+
+    #Add bytes from one read/notification, delivers if the batch is due
+    def add(self, data):
+        if not data:
+            return
+        now = time.perf_counter()
+        with self.lock:
+            if not self.buffer:
+                self.first_pending_time = now
+            self.buffer.extend(data)
+            self.chunks_in += 1
+            self.bytes_in += len(data)
+            batch = self._take_if_due(now)
+        if batch:
+            self._deliver(batch)
+
+    #Deliver pending bytes if they have waited long enough, call when a read times out
+    def flush_if_due(self):
+        with self.lock:
+            batch = self._take_if_due(time.perf_counter())
+        if batch:
+            self._deliver(batch)
+
+    #Deliver everything pending now
+    def flush(self):
+        with self.lock:
+            batch = self._take()
+        if batch:
+            self._deliver(batch)
+
+    #Drop pending bytes without delivering (disconnect)
+    def clear(self):
+        with self.lock:
+            self.buffer = bytearray()
+            self.first_pending_time = None
+
+    #Seconds until the pending batch is due, None if nothing pending
+    def time_until_due(self):
+        with self.lock:
+            if not self.buffer:
+                return None
+            return max(0.0, self.interval - (time.perf_counter() - self.first_pending_time))
+
+    #Take batch if interval elapsed or byte threshold reached, lock must be held
+    def _take_if_due(self, now):
+        if not self.buffer:
+            return None
+        if len(self.buffer) >= self.max_bytes or now - self.first_pending_time >= self.interval:
+            return self._take()
+        return None
+
+    #Take pending bytes, lock must be held
+    def _take(self):
+        if not self.buffer:
+            return None
+        batch = bytes(self.buffer)
+        self.buffer = bytearray()
+        self.first_pending_time = None
+        self.events_out += 1
+        self._update_rates()
+        return batch
+
+    #Roll per second rates once a second has passed, lock must be held
+    def _update_rates(self):
+        now = time.perf_counter()
+        elapsed = now - self._rate_start
+        if elapsed < 1.0:
+            return
+        chunks, events, byte_count = self._rate_counts
+        self.chunks_per_second = (self.chunks_in - chunks) / elapsed
+        self.events_per_second = (self.events_out - events) / elapsed
+        self.bytes_per_second = (self.bytes_in - byte_count) / elapsed
+        self._rate_start = now
+        self._rate_counts = (self.chunks_in, self.events_out, self.bytes_in)
+
+    #Deliver outside the lock so the callback can take its time
+    def _deliver(self, batch):
+        self.deliver(batch)
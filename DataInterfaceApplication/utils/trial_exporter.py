@@ -0,0 +1,119 @@
+"""
+Trial Exporter - Writes trial data straight from the sample arrays
+CSV is formatted and written in fixed size chunks, so memory stays bounded for any trial length.
+Binary exports (.npz, .parquet when pyarrow is installed) store the columns as they are, with
+trial metadata (peak torque, RTD, sample rate, limb length) in a JSON sidecar next to the file.
+
+Usage:
+    columns = {"Time (s)": time_array, "Torque (N·m)": torque_array}
+    metadata = {"Peak Torque (N·m)": peak, "Rate of Torque Dev (N·m/s)": rtd}
+    export_trial(path, columns, metadata, details={"sample_rate": 1200})
+"""
+
+import json
+import os
+import numpy as np
+
+CHUNK_ROWS = 65536      #rows formatted per CSV write
+
+try:
+    import pyarrow
+    import pyarrow.parquet
+    PARQUET_AVAILABLE = True
+except ImportError:
+    PARQUET_AVAILABLE = False
+
+#File dialog filter for the formats available on this machine
+def file_dialog_filter():
+    filters = ["CSV Files (*.csv)", "NumPy Archive (*.npz)"]
+    if PARQUET_AVAILABLE:
+        filters.append("Parquet Files (*.parquet)")
+    return ";;".join(filters)
+
+#Export by file extension, returns path written
+#metadata is written to every format, details (sample rate, limb length...) only to binary sidecars
+#formats: printf style CSV format per column name
+def export_trial(path, columns, metadata, details=None, formats=None):
+    extension = os.path.splitext(path)[1].lower()
+    if extension == ".npz":
+        export_npz(path, columns, {**metadata, **(details or {})})
+    elif extension == ".parquet":
+        export_parquet(path, columns, {**metadata, **(details or {})})
+    else:
+        export_csv(path, columns, metadata, formats)
+    return path
+
+#CSV with one column per array, metadata values written on the first row only
+#formats: printf style format per column, "%.6f" if not given
+def export_csv(path, columns, metadata, formats=None):
+    names = list(columns)
+    arrays = [np.asarray(columns[name], dtype=np.float64) for name in names]
+    row_count = len(arrays[0]) if arrays else 0
+    formats = formats or {}
+    column_formats = [formats.get(name, "%.6f") for name in names]
+
+    metadata_names = list(metadata)
+    metadata_text = [_format_metadata(name, metadata[name]) for name in metadata_names]
+
+    #Remaining rows leave the metadata columns blank
+    row_format = ",".join(column_formats) + "," * len(metadata_names) + "\n"
+
+    #utf-8-sig so Excel reads the N·m unit correctly
+    with open(path, "w", encoding="utf-8-sig", newline="") as f:
+        f.write(",".join(_quote(name) for name in names + metadata_names) + "\n")
+        if row_count == 0:
+            return
+
+        first_row = [fmt % array[0] for fmt, array in zip(column_formats, arrays)]
+        f.write(",".join(first_row + metadata_text) + "\n")
+
+        for start in range(1, row_count, CHUNK_ROWS):
+            stop = min(start + CHUNK_ROWS, row_count)
+            #Interleave columns row-major, then one format operation for the whole chunk
+            block = np.column_stack([array[start:stop] for array in arrays]).ravel()
+            f.write((row_format * (stop - start)) % tuple(block.tolist()))
+
+#NumPy archive, one array per column, metadata in sidecar JSON
+def export_npz(path, columns, metadata):
+    arrays = {_array_name(name): np.asarray(values) for name, values in columns.items()}
+    np.savez(path, **arrays)
+    write_sidecar(path, columns, metadata)
+
+#Parquet file (needs pyarrow), metadata also stored in the file schema
+def export_parquet(path, columns, metadata):
+    if not PARQUET_AVAILABLE:
+        raise RuntimeError("Parquet export needs pyarrow installed")
+    table = pyarrow.table({name: np.asarray(values) for name, values in columns.items()})
+    table = table.replace_schema_metadata({"lsmd": json.dumps(metadata)})
+    pyarrow.parquet.write_table(table, path)
+    write_sidecar(path, columns, metadata)
+
+#Sidecar JSON next to a binary export: metadata plus column names and units
+def write_sidecar(path, columns, metadata):
+    sidecar = {
+        "data_file": os.path.basename(path),
+        "columns": {_array_name(name): name for name in columns},
+        "sample_count": len(next(iter(columns.values()))) if columns else 0,
+        "metadata": metadata,
+    }
+    with open(os.path.splitext(path)[0] + ".json", "w", encoding="utf-8") as f:
+        json.dump(sidecar, f, indent=2, ensure_ascii=False)
+
+#Column name usable as an array key, e.g. "Torque (N·m)" -> "torque"
+def _array_name(name):
+    return name.split("(")[0].strip().lower().replace(" ", "_")
+
+#Quote CSV header field if needed
+def _quote(text):
+    if "," in text or '"' in text:
+        return '"' + text.replace('"', '""') + '"'
+    return text
+
+#Metadata value as CSV text, None as dash
+#Times ("(s)" columns) to 0.1 ms so onset keeps sample resolution up to 5 kHz, other floats to 2 decimals
+def _format_metadata(name, value):
+    if value is None:
+        return "—"
+    if isinstance(value, float):
+        return f"{value:.4f}" if name.endswith("(s)") else f"{value:.2f}"
+    return _quote(str(value))
@@ -6,6 +6,8 @@ USB Manager - Handles USB connections using pyserial library
 import serial
 import serial.tools.list_ports
 from PyQt6.QtCore import QObject, pyqtSignal, QThread
+from utils.transport_batcher import TransportBatcher
+from utils.serial_reader import SerialReader
 
 """
 Manages USB connections
@@ -191,6 +193,10 @@ class USBWorker(QThread):
         
         self.running = False    #flag for read loop
 
+        #Reads are coalesced and data_received is emitted at most every ~15 ms
+        self.batcher = TransportBatcher(self.data_received.emit)
+        self.reader = None      #adaptive reader for the open port, holds read statistics
+
         #Auto reconnect settings
         self.connection_timeout = 5.0
         self.auto_reconnect = False
@@ -231,22 +237,28 @@ class USBWorker(QThread):
             self.running = False    #stop program
 
     #Blocking read loop while connected, blocks until data is available or timeout elapse
-    #no polling, no msleep
+    #no polling, no msleep, each read takes everything the driver holds
     def _read_loop(self):
-        CHUNK = 256  # read up to 256 bytes at a time
+        self.reader = SerialReader(self.manager.serial_port)
 
         while self.running and self.manager.is_connected:
             try:
-                data = self.manager.serial_port.read(CHUNK)
-                if data:
-                    self.data_received.emit(data)
-                # else: timeout elapsed, loop re-checks self.running
+                data = self.reader.read()
+                if data is not None:
+                    self.batcher.add(data)
+                else:
+                    #timeout elapsed, deliver any held bytes then loop re-checks self.running
+                    self.batcher.flush_if_due()
 
             except Exception as e:
                 if self.running:
                     self.error.emit(f"Error in read loop: {str(e)}")
                 break
 
+        self.batcher.flush()    #deliver bytes read before the loop ended
+        print(f"USB read loop ended: {self.reader.bytes_read} bytes in {self.reader.reads} reads, "
+              f"largest {self.reader.largest_read} bytes, read latency {self.reader.read_latency_ms:.3f} ms")
+
         if self.running and self.auto_reconnect:
             self.attempt_reconnect()
     
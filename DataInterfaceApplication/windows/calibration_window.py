@@ -149,6 +149,18 @@ class CalibrationWindow(QWidget):
                     font-weight: 600;
                 }
             """)
+        elif self.connection_type == "replay":
+            self.status_indicator = QLabel("Replay")
+            self.status_indicator.setStyleSheet("""
+                QLabel {
+                    background-color: #6F42C1;
+                    color: white;
+                    padding: 6px 14px;
+                    border-radius: 4px;
+                    font-size: 11px;
+                    font-weight: 600;
+                }
+            """)
         else:
             self.status_indicator = QLabel("USB Connected")
             self.status_indicator.setStyleSheet("""
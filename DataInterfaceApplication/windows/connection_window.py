@@ -1,6 +1,6 @@
 """
 Connection Window - Device Connection Screen
-User selects USB or Bluetooth connection
+User selects USB or Bluetooth connection, replay of a recorded trial, or several devices at once
 """
 from PyQt6.QtWidgets import (QWidget, QLabel, QPushButton, QVBoxLayout,
                              QHBoxLayout, QFrame)
@@ -12,6 +12,8 @@ class ConnectionWindow(QWidget):
     #Define signals
     usb_selected = pyqtSignal()
     bluetooth_selected = pyqtSignal()
+    replay_selected = pyqtSignal()
+    multi_device_selected = pyqtSignal()
 
     def __init__(self):
         super().__init__()
@@ -35,7 +37,7 @@ class ConnectionWindow(QWidget):
 
         #Central content
         central_widget = QWidget()
-        central_widget.setMaximumWidth(650)
+        central_widget.setMaximumWidth(950)
         central_layout = QVBoxLayout(central_widget)
         central_layout.setSpacing(40)
 
@@ -163,13 +165,31 @@ class ConnectionWindow(QWidget):
             is_primary=False
         )
 
+        #Replay Card, recorded session through the live pipeline
+        replay_card = self.create_card(
+            icon="⟲",
+            title="Replay Recording",
+            button_text="Replay Session",
+            on_clicked=self.on_replay_clicked
+        )
+
+        #Multi-device Card, several devices on one aligned timeline
+        multi_device_card = self.create_card(
+            icon="⧉",
+            title="Multiple Devices",
+            button_text="Connect Devices",
+            on_clicked=self.on_multi_device_clicked
+        )
+
         cards_layout.addWidget(usb_card)
         cards_layout.addWidget(bluetooth_card)
+        cards_layout.addWidget(replay_card)
+        cards_layout.addWidget(multi_device_card)
 
         layout.addLayout(cards_layout)
     
     #Cards
-    def create_card(self, icon, title, button_text, is_primary=False):
+    def create_card(self, icon, title, button_text, is_primary=False, on_clicked=None):
         card = QFrame()
         card.setFixedSize(280, 240)
 
@@ -188,7 +208,9 @@ class ConnectionWindow(QWidget):
         button.setCursor(Qt.CursorShape.PointingHandCursor)
         button.setMinimumHeight(44)
 
-        if is_primary:
+        if on_clicked:
+            button.clicked.connect(on_clicked)
+        elif is_primary:
             #Black button
             button.clicked.connect(self.on_usb_clicked)
         else:
@@ -225,6 +247,15 @@ class ConnectionWindow(QWidget):
         self.update_connection_status("Bluetooth")
         self.bluetooth_selected.emit()
 
+    #Replay
+    def on_replay_clicked(self):
+        self.update_connection_status("Replay")
+        self.replay_selected.emit()
+
+    #Multiple devices
+    def on_multi_device_clicked(self):
+        self.multi_device_selected.emit()
+
     #Update the connection status badge
     def update_connection_status(self, connection_type=None):
         if connection_type == "USB":
@@ -253,6 +284,19 @@ class ConnectionWindow(QWidget):
                 }
             """)
         
+        elif connection_type == "Replay":
+            self.status_label.setText("Replay")
+            self.status_label.setStyleSheet("""
+                QLabel {
+                    background-color: #6F42C1;
+                    color: white;
+                    padding: 6px 14px;
+                    border-radius: 4px;
+                    font-size: 11px;
+                    font-weight: 600;
+                }
+            """)
+
         else:
             self.status_label.setText("Not Connected")
             self.status_label.setStyleSheet("""
@@ -12,9 +12,15 @@ from PyQt6.QtCore import Qt, pyqtSignal, QTimer
 from PyQt6.QtGui import QFont
 import pyqtgraph as pg
 import numpy as np
-from collections import deque
 import time
-import pandas as pd
+import os
+from utils.acquisition_pipeline import AcquisitionPipeline, PipelineWorker
+from utils.latency_probe import LatencyProbe
+from utils.render_scheduler import RenderScheduler
+from utils.spectrum_analyzer import SpectrumAnalyzer
+from utils.session_file import SessionWriter, SessionReader, new_session_path
+from utils import trial_exporter
+from utils import torque_analysis
 
 #Data acquisition dashboard screen
 class DataAcquisitionDashboard(QWidget):
@@ -36,14 +42,22 @@ class DataAcquisitionDashboard(QWidget):
         
 
         #Data storage for plotting - 10 seconds at 600Hz = 12,000 points max
-        self.sample_rate = 1200  # Hz
-        self.max_duration = 10   # seconds
+        self.sample_rate = 1200  # Hz, of the data shown (a loaded session may differ from the device)
+        self.device_sample_rate = self.sample_rate  #rate of the connected device or replay source, live trials use it
+        self.max_duration = 10   # seconds, trial length and display window when not recording to a session file
         self.max_data_points = self.sample_rate * self.max_duration
-        self.raw_force_data = deque(maxlen=self.max_data_points) #unfiltered force data
-        self.time_data = deque(maxlen=self.max_data_points)
-        self.force_data = deque(maxlen=self.max_data_points)
-        self.data_point_count = 0
-        self.data_buffer = ""    #Buffer for incomplete data
+        #Decoding, calibration, filtering and storage run on the pipeline worker thread
+        self.pipeline = AcquisitionPipeline(self.max_data_points, self.sample_rate)
+        self._tick_max_time = None      #last x-axis max ticks were built for
+        self._updating_plot = False
+
+        #Plot redraws at a fixed frame rate, only when new data arrived
+        self.render_frame_rate = 30  # Hz
+        self.render_scheduler = RenderScheduler(self.update_plot, frame_rate=self.render_frame_rate)
+        self.render_scheduler.frame_rendered.connect(lambda ms: self.pipeline.stats.record("render", ms / 1000.0))
+        self.pipeline_worker = PipelineWorker(self.pipeline, on_processed=self.render_scheduler.mark_dirty)
+        self.pipeline_worker.error.connect(lambda message: print(message))
+        self.pipeline_worker.start()
         self.acquisition_start_time = None
         self.x_axis_max = 1
         self.acquisition_timer = QTimer()
@@ -52,13 +66,23 @@ class DataAcquisitionDashboard(QWidget):
         self.rate_start_line = None
         self.rate_end_line = None
 
+        #Live spectrum of the newest samples, before (raw_force) and after (force) the active filters
+        self.raw_spectrum = SpectrumAnalyzer(self.sample_rate)
+        self.filtered_spectrum = SpectrumAnalyzer(self.sample_rate)
+
         self.peak_torque = 0.0  #peak torque value for export (N·m)
         self.rtd = None        #rate of torque development for export (N·m/s), None if not calculated
-
-        self.zero_offset = 0.0
-        self.piecewise_cal = None
+        self.analysis = None   #onset and windowed RTD of the last trial, TorqueAnalysis
 
         self.settings_window = None  #set for limb length access
+        self.session_dir = None      #set to record each trial to a session file
+        self.session_path = None     #session file of the current or last trial
+
+        #Latency probe mode, pings the device while acquiring (enable_latency_probe)
+        self.latency_probe = None
+        self.latency_log = None
+        self.ping_timer = QTimer()
+        self.ping_timer.timeout.connect(lambda: self.send_data.emit(self.latency_probe.ping()))
         
         self.init_ui()
 
@@ -134,6 +158,20 @@ class DataAcquisitionDashboard(QWidget):
                     font-weight: 600;
                 }
             """)
+        elif self.connection_type == "replay":
+            #Exported CSV torque was filtered before export, active filters apply on top
+            csv_source = (self.port_name or "").lower().endswith(".csv")
+            self.status_indicator = QLabel("Replay (CSV, pre-filtered)" if csv_source else "Replay")
+            self.status_indicator.setStyleSheet("""
+                QLabel {
+                    background-color: #6F42C1;
+                    color: white;
+                    padding: 6px 14px;
+                    border-radius: 4px;
+                    font-size: 11px;
+                    font-weight: 600;
+                }
+            """)
         else:
             self.status_indicator = QLabel("USB Connected")
             self.status_indicator.setStyleSheet("""
@@ -372,6 +410,22 @@ class DataAcquisitionDashboard(QWidget):
         export_button.clicked.connect(self.on_export_csv_clicked)
 
         card_layout.addWidget(export_button)
+
+        # Open Session button
+        open_session_button = QPushButton("Open Session")
+        open_session_button.setStyleSheet("""
+            QPushButton {
+                background-color: transparent;
+                color: #666666;
+                border: 1px solid #E0E0E0;
+                border-radius: 2px;
+                padding: 7px 12px;
+                font-size: 12px;
+                margin: 0px;
+            }
+        """)
+        open_session_button.clicked.connect(self.on_open_session_clicked)
+        card_layout.addWidget(open_session_button)
         card_layout.addStretch(1)
         
         return card
@@ -487,6 +541,27 @@ class DataAcquisitionDashboard(QWidget):
         header_layout.addWidget(title_label)
         header_layout.addWidget(subtitle_label)
         header_layout.addStretch(1)
+
+        #Show or hide spectrum panel under the torque plot
+        self.spectrum_button = QPushButton("Spectrum")
+        self.spectrum_button.setCheckable(True)
+        self.spectrum_button.setStyleSheet("""
+            QPushButton {
+                background-color: transparent;
+                color: #666666;
+                border: 1px solid #E0E0E0;
+                border-radius: 2px;
+                padding: 4px 10px;
+                font-size: 11px;
+            }
+            QPushButton:checked {
+                background-color: #1A1A1A;
+                color: white;
+                border: none;
+            }
+        """)
+        self.spectrum_button.toggled.connect(self.on_spectrum_toggled)
+        header_layout.addWidget(self.spectrum_button)
         
         graph_layout.addLayout(header_layout)
         
@@ -514,6 +589,16 @@ class DataAcquisitionDashboard(QWidget):
         #Create plot line
         self.line = self.plot_widget.plot([], [], pen=pg.mkPen(color='#2196F3', width=2))
 
+        #Vertical markers where samples were lost (sequence gaps) or the stream stalled (no sequence numbers)
+        self.gap_markers = self.plot_widget.plot([], [], pen=pg.mkPen(color='#DC3545', width=1), connect="pairs")
+        self.stall_markers = self.plot_widget.plot([], [], pen=pg.mkPen(color='#FD7E14', width=1, style=Qt.PenStyle.DashLine),
+                                                   connect="pairs")
+        self.gap_times = []
+        self.stall_times = []
+
+        #Redraw line at matching envelope level whenever visible time range changes
+        self.plot_widget.getViewBox().sigXRangeChanged.connect(self._on_view_range_changed)
+
         #Set initial ranges
         #self.plot_widget.setXRange(0, 10, padding=0)
         self.plot_widget.setYRange(0, 500, padding=0)
@@ -524,9 +609,45 @@ class DataAcquisitionDashboard(QWidget):
         canvas_layout.setContentsMargins(0, 0, 0, 0)
         canvas_layout.addWidget(self.plot_widget)
         graph_layout.addWidget(canvas_widget)
+
+        self.create_spectrum_display(graph_layout)
         
         layout.addWidget(graph_card)
 
+    #Spectrum panel, hidden until the Spectrum button is checked
+    def create_spectrum_display(self, layout):
+        self.spectrum_widget = QWidget()
+        spectrum_layout = QVBoxLayout(self.spectrum_widget)
+        spectrum_layout.setContentsMargins(0, 0, 0, 0)
+        spectrum_layout.setSpacing(4)
+
+        self.spectrum_label = QLabel("Power spectrum of the newest samples: raw (grey), filtered (blue)")
+        self.spectrum_label.setStyleSheet("color: #666666; font-size: 11px; background: transparent; border: none;")
+        spectrum_layout.addWidget(self.spectrum_label)
+
+        self.spectrum_plot = pg.PlotWidget()
+        self.spectrum_plot.setBackground('#FAFAFA')
+        self.spectrum_plot.showGrid(x=True, y=True, alpha=0.2)
+        self.spectrum_plot.setLabel('bottom', 'Frequency (Hz)')
+        self.spectrum_plot.setLabel('left', 'dB (N²/Hz)')
+        self.spectrum_plot.setMouseEnabled(x=False, y=False)
+        self.spectrum_plot.setMenuEnabled(False)
+        self.spectrum_plot.setXRange(0, self.sample_rate / 2.0, padding=0)
+        self.spectrum_y_range = (-100.0, 0.0)
+        self.spectrum_plot.setYRange(*self.spectrum_y_range, padding=0)
+        self.spectrum_plot.setFixedHeight(180)
+
+        self.raw_spectrum_line = self.spectrum_plot.plot([], [], pen=pg.mkPen(color='#9E9E9E', width=1))
+        self.filtered_spectrum_line = self.spectrum_plot.plot([], [], pen=pg.mkPen(color='#2196F3', width=1.5))
+
+        #Notch frequencies and Butterworth cutoff of the active filters
+        self.filter_markers = self.spectrum_plot.plot([], [], pen=pg.mkPen(color='#DAA520', width=1, style=Qt.PenStyle.DashLine),
+                                                      connect="pairs")
+        spectrum_layout.addWidget(self.spectrum_plot)
+
+        self.spectrum_widget.setVisible(False)
+        layout.addWidget(self.spectrum_widget)
+
     #Stats cards
     def create_stats_cards(self, layout):
         stats_layout = QHBoxLayout()
@@ -602,13 +723,17 @@ class DataAcquisitionDashboard(QWidget):
             self.stop_button.setChecked(False)
             self.update_button_styles()
 
-            #Clear data
-            self.time_data.clear()
-            self.force_data.clear()
-            self.raw_force_data.clear()
-            self.data_point_count = 0
+            #Clear data, transient samples at start are removed by the pipeline
+            #Trials recorded to a session file keep every sample and run until stopped,
+            #otherwise only the newest max_duration seconds are kept and the trial stops after them
+            #A session loaded for review may have left another rate and store size, live trials use the device's
+            self.pipeline_worker.drain()
+            self.set_sample_rate(self.device_sample_rate)
+            self._open_session()
+            recording = self.pipeline.session_writer is not None
+            self.pipeline.set_store(self.max_data_points, growable=recording)
+            self.pipeline.set_limb_length(self.get_limb_length_m())
             self.acquisition_start_time = None
-            self._transient_count = 0  #hardcode remove transients at start of sample
 
             #Reset peak value
             self.peak_value_label.setText("0.0 N·m")
@@ -620,6 +745,8 @@ class DataAcquisitionDashboard(QWidget):
             self.rate_end_input.clear()
             self.rate_value_label.setText("—")
             self.clear_rate_lines()
+            self.clear_gap_markers()
+            self.clear_spectrum()
 
             #Update recording status
             self.recording_status_label.setText("Recording")
@@ -636,14 +763,28 @@ class DataAcquisitionDashboard(QWidget):
 
             #Send start command
             self.x_axis_max = 1 #minimum 1 second display
-            self.acquisition_timer.start(self.max_duration * 1000) #start timer for max duration
+            if not recording:
+                self.acquisition_timer.start(self.max_duration * 1000) #start timer for max duration
+            self.render_scheduler.start()
             self.send_data.emit("start")
+            if self.latency_probe is not None:
+                self.latency_probe.reset()
+                self.ping_timer.start()
             print("Acquisition started")
     
     #Stop clicked
     def on_stop_clicked(self):
         if self.is_acquiring:
-            self.is_acquiring = False
+            self.ping_timer.stop()
+            self.is_acquiring = False       #append_data stops queueing before the queue is drained
+            self.pipeline_worker.drain()    #process chunks still queued
+            self._close_session()
+            #Last frame still follows the data, update_plot only scales the x axis while acquiring
+            with self.pipeline.lock:
+                max_time = self.samples.last("time")
+            if max_time is not None:
+                self.x_axis_max = max(max_time, 1)
+            self.render_scheduler.stop()    #draws any samples since last frame
             self.start_button.setChecked(False)
             self.stop_button.setChecked(True)
             self.update_button_styles()
@@ -665,18 +806,31 @@ class DataAcquisitionDashboard(QWidget):
             self.send_data.emit("stop")
             print("Acquisition stopped")
             print(f"Data points: {self.data_point_count}")
-
-            #Enable rate analysis inputs
+            print(self.pipeline.stats.report())
+            print(self.pipeline.monitor.report())
+            if self.pipeline.samples_lost:
+                print(f"Samples lost: {self.pipeline.samples_lost} in {len(self.pipeline.gaps)} gaps, marked on the plot")
+            if self.pipeline_worker.chunks_dropped:
+                print(f"Chunks dropped (pipeline queue full): {self.pipeline_worker.chunks_dropped}")
+            decoder = self.pipeline.stream_decoder
+            if decoder.frames_dropped or decoder.resyncs:
+                print(f"Frames dropped (duplicate or corrupted sequence): {decoder.frames_dropped}, resyncs: {decoder.resyncs}")
+            if self.latency_probe is not None:
+                self._save_latency_probe()
+
+            #Replace live causal filtering with zero-phase pass over the whole trial
+            if self.pipeline.filters:
+                self.apply_filter(self.pipeline.filters)
+
+            #Enable rate analysis inputs, filled from detected onset
             self.rate_start_input.setEnabled(True)
             self.rate_end_input.setEnabled(True)
+            self.run_torque_analysis()
     
     #Clear data clicked
     def on_clear_data_clicked(self):
         if not self.is_acquiring:
-            self.time_data.clear()
-            self.force_data.clear()
-            self.raw_force_data.clear()
-            self.data_point_count = 0
+            self.pipeline.reset()
             self.acquisition_start_time = None
             self.x_axis_max = 1
             self.peak_value_label.setText("0.0 N·m")
@@ -694,44 +848,129 @@ class DataAcquisitionDashboard(QWidget):
             self.rate_end_input.clear()
             self.rate_value_label.setText("—")
             self.clear_rate_lines()
+            self.clear_gap_markers()
+            self.clear_spectrum()
+            self.analysis = None
+            self.rate_windows_label.setText("")
 
             #Emit signal to clear filters
             self.clear_data_selected.emit()
     
-    #Export CSV clicked
+    #Start recording trial to a new session file, acquisition continues without one if it cannot be created
+    def _open_session(self):
+        if not self.session_dir:
+            return
+        try:
+            self.session_path = new_session_path(self.session_dir)
+            self.pipeline.session_writer = SessionWriter(self.session_path, self.sample_rate,
+                                                         calibration=self.piecewise_cal,
+                                                         zero_offset=self.zero_offset,
+                                                         limb_length_m=self.get_limb_length_m())
+            print(f"Recording session to {self.session_path}")
+        except OSError as e:
+            self.session_path = None
+            print(f"Session file not created: {str(e)}")
+
+    #Finish session file of the current trial
+    def _close_session(self):
+        writer = self.pipeline.take_session_writer()
+        if writer is None:
+            return
+        writer.close()
+        print(f"Session saved: {writer.sample_count} samples")
+
+    #Open Session clicked, load a recorded trial for review
+    def on_open_session_clicked(self):
+        if self.is_acquiring:
+            return
+
+        file_path, _ = QFileDialog.getOpenFileName(
+            self,
+            "Open Session File",
+            self.session_dir or "",
+            "LSMD Sessions (*.lsmd)"
+        )
+        if not file_path:
+            return
+
+        try:
+            session = SessionReader(file_path)
+        except (OSError, ValueError) as e:
+            print(f"Could not open session: {str(e)}")
+            return
+
+        self.session_path = file_path
+        self.set_sample_rate(session.sample_rate)
+        self.pipeline.set_limb_length(self.get_limb_length_m())
+        self.pipeline.load_session(session)
+        print(f"Session loaded: {len(session)} samples from {file_path}")
+
+        #Show whole session, enable rate analysis
+        self.peak_value_label.setText("0.0 N·m")
+        self.rate_start_input.clear()
+        self.rate_end_input.clear()
+        self.rate_value_label.setText("—")
+        self.clear_rate_lines()
+        self.clear_gap_markers()
+        self.clear_spectrum()
+        self.x_axis_max = max(self.samples.last("time") or 0.0, 1)
+        self.update_plot()
+        self.rate_start_input.setEnabled(True)
+        self.rate_end_input.setEnabled(True)
+        self.run_torque_analysis()
+
+    #Export CSV clicked, also offers binary formats
     def on_export_csv_clicked(self):
-        if(len(self.force_data) == 0):
+        if(len(self.samples) == 0):
             print("No data to export")
             return
         
-        #Save file dialog (in settings in future)
-        file_path, _ = QFileDialog.getSaveFileName(
+        #Save file dialog (in settings in future), format follows the chosen extension
+        file_path, selected_filter = QFileDialog.getSaveFileName(
             self,
             "Save CSV File",       #Window title
             "lsmd_data.csv",       #Default file name
-            "CSV Files (*.csv)"    #File filter
+            trial_exporter.file_dialog_filter()    #CSV, npz, parquet if available
         )
 
         #If closed without selecting file, return
         if not file_path:
             return
+        if not os.path.splitext(file_path)[1]:
+            file_path += selected_filter[selected_filter.index("*") + 1:-1]
         
         limb_m = self.get_limb_length_m()
-        #DataFrame with time and torque values
-        df = pd.DataFrame({
-            "Time (s)": list(self.time_data),
-            "Torque (N·m)": [round(f * limb_m, 2) for f in self.force_data]}
-        )
+        #Time and torque columns written from the stored arrays, no intermediate table
+        columns = {
+            "Time (s)": self.samples.view("time"),
+            "Torque (N·m)": self.samples.view("force") * limb_m,
+        }
 
         #Peak torque and RTD written to row 1 only — remaining rows left blank
-        peak_col = [f"{self.peak_torque:.2f}"] + [""] * (len(self.time_data) - 1)
-        rate_col  = [f"{self.rtd:.2f}" if self.rtd is not None else "—"] + [""] * (len(self.time_data) - 1)
-
-        df["Peak Torque (N·m)"]            = peak_col
-        df["Rate of Torque Dev (N·m/s)"]   = rate_col
+        metadata = {
+            "Peak Torque (N·m)": float(self.peak_torque),
+            "Rate of Torque Dev (N·m/s)": float(self.rtd) if self.rtd is not None else None,
+            "Limb Length (cm)": limb_m * 100.0,     #lets a replay turn torque back into force
+        }
+        analysis = self.analysis
+        if analysis is not None and analysis.onset_time is not None:
+            metadata["Onset (s)"] = analysis.onset_time
+            for window, rate in analysis.rtd_windows.items():
+                metadata[f"RTD 0-{window * 1000:.0f} ms (N·m/s)"] = rate
+            metadata["Peak Slope (N·m/s)"] = analysis.peak_slope
+        details = {
+            "sample_rate": self.sample_rate,
+            "limb_length_m": limb_m,
+            "zero_offset": self.zero_offset,
+            "session_file": self.session_path,
+        }
 
-        #Write dataframe to CSV
-        df.to_csv(file_path, index=False, encoding='utf-8-sig')
+        try:
+            trial_exporter.export_trial(file_path, columns, metadata, details,
+                                        formats={"Time (s)": "%.6f", "Torque (N·m)": "%.2f"})
+        except (OSError, RuntimeError) as e:
+            print(f"Export failed: {str(e)}")
+            return
         print(f"Data exported to {file_path}")
     
     #Update button styles based on acquisition state
@@ -799,128 +1038,108 @@ class DataAcquisitionDashboard(QWidget):
         self.disconnect_request.emit()
         print("Disconnected from device")
     
-    #Data display, receive data and updates plot
+    #Data display, queue received bytes for the pipeline worker, plot updates at the next frame
+    #Transport threads call this directly, so it must not touch widgets
     def append_data(self, data):
         if not self.is_acquiring:
             return
-        
-        #Convert bytes to string
-        if isinstance(data, bytes):
-            try:
-                data = data.decode('utf-8')
-            except:
-                print(f"Could not decode data: {data}")
-                return
-        
-        #Add to buffer
-        self.data_buffer += data
-        
-        #Process complete lines
-        while '\n' in self.data_buffer:
-            line, self.data_buffer = self.data_buffer.split('\n', 1)
-            line = line.strip()
-            
-            if not line:
-                continue
-            
-            #Try to parse as float
-            try:
-                force_value = float(line)
-
-                #Reject values outside of expected 10 bit range (0-1023)
-                if force_value < 0 or force_value > 1023:
-                    continue
-
-                #Discard first 25 samples to remove BLE connection transient
-                if self._transient_count < 25:
-                    self._transient_count += 1
-                    continue
-
-                #Calculate time from sample count
-                time_value = self.data_point_count / self.sample_rate
-
-                #Apply piecewise calibration if available, otherwise pass raw ADC value
-                if self.piecewise_cal and self.piecewise_cal.is_calibrated:
-                    corrected_value = self.piecewise_cal.adc_to_newtons(force_value) - self.zero_offset
-                else:
-                    corrected_value = force_value - self.zero_offset
-
-                self.time_data.append(time_value)
-                self.force_data.append(corrected_value)
-                self.raw_force_data.append(corrected_value)
-                self.data_point_count += 1
-
-                #Update plot every 60 points (~50ms at 1200 Hz)
-                if self.data_point_count % 60 == 0:
-                    self.update_plot()
-                    
-            except ValueError:
-                print(f"Could not parse: {line}")
+        self.pipeline_worker.submit(data)
     
-    #Acquisition timeout (10 seconds)
+    #Acquisition timeout (max_duration, only for trials not recorded to a session file)
     def _on_acquisition_timeout(self):
-        self.x_axis_max = self.max_duration
         self.on_stop_clicked()     #stop acquisition
+        self.x_axis_max = self.max_duration
         self.update_plot()         #update plot with final data
         
         
+    #Redraw from stored views, cost does not depend on trial length beyond the line itself
     def update_plot(self):
-        if len(self.time_data) > 0:
-            limb_m = self.get_limb_length_m()
-            torque_data = [f * limb_m for f in self.force_data]
-            self.line.setData(list(self.time_data), torque_data)
-
-            #Auto-scale x-axis as data acquired, max 10 seconds
-            max_time = max(self.time_data)
+        #Read before the snapshot so every sample counted as displayed is in it
+        displayed_index = self.pipeline.last_stream_index
+        if self.pipeline.sample_count > 0:
+            #Recompute torque only if limb length changed since it was last built
+            self.pipeline.set_limb_length(self.get_limb_length_m())
+
+            #Auto-scale x-axis as data acquired, trials without a session file stop at max_duration
+            with self.pipeline.lock:
+                max_time = self.samples.last("time")
             if self.is_acquiring:
                 self.x_axis_max = max(max_time, 1)
             #self.plot_widget.setXRange(0, self.x_axis_max, padding=0)
+            self._updating_plot = True
             self.update_time_ticks(self.x_axis_max)
-
+            self._updating_plot = False
+            snapshot = self._render_line()
+            if snapshot is None:
+                return
+            max_time = snapshot.last_time
 
             #Auto-scale y-axis
-            if len(torque_data) > 0:
-                min_torque = min(torque_data)
-                max_torque = max(torque_data)
+            if snapshot.torque_max is not None:
+                min_torque = snapshot.torque_min
+                max_torque = snapshot.torque_max
                 margin = (max_torque - min_torque) * 0.1 if max_torque > min_torque else 10
                 self.plot_widget.setYRange(max(0, min_torque - margin), max_torque + margin)
+                self.update_gap_markers(max(0, min_torque - margin), max_torque + margin)
 
                 #Update peak torque value
                 self.peak_torque = max_torque
                 self.peak_value_label.setText(f"{max_torque:.2f} N·m")
 
-            self.stats_data_points.setText(str(self.data_point_count))
+            lost = self.pipeline.samples_lost
+            self.stats_data_points.setText(f"{snapshot.sample_count} ({lost} lost)" if lost else str(snapshot.sample_count))
             self.stats_duration.setText(f"{max_time:.1f} s")
 
+            if self.latency_probe is not None and self.is_acquiring:
+                self.latency_probe.on_displayed(displayed_index)
+            self.update_spectrum()
+
             #Send heartbeat to confirm updating
             #if self.is_acquiring:
             #    self.send_data.emit("stop")
     
     #Apply ordered list of filters to raw data, or revert if list is empty
+    #While acquiring the filters are primed causally over the history and then continue block by block
     def apply_filter(self, filter_list):
-        if len(self.raw_force_data) == 0:
+        self.pipeline.set_filters(filter_list, causal=self.is_acquiring)
+        self.filtered_spectrum.reset()  #force column was re-filtered
+        self.update_filter_markers()
+        if self.pipeline.sample_count == 0:
             return
+        self.update_plot()
 
-        # Start from raw data
-        filtered = list(self.raw_force_data)
-
-        # Apply each filter in order (notch, butterworth, moving average)
-        for f in filter_list:
-            filtered = f.apply(filtered)
+    #Draw the visible part of the torque trace, decimated to min/max envelope at about 2 points per pixel
+    #Returns the snapshot drawn, None if nothing stored
+    def _render_line(self):
+        if self.pipeline.sample_count == 0:
+            return None
+        (view_start, view_end), _ = self.plot_widget.getViewBox().viewRange()
+        max_points = 2 * max(int(self.plot_widget.width()), 100)
 
-        self.force_data.clear()
-        self.force_data.extend(filtered)
+        snapshot = self.pipeline.snapshot(view_start, view_end, max_points)
+        self.line.setData(snapshot.line_x, snapshot.line_y)
+        return snapshot
 
-        self.update_plot()
+    #View range changed (zoom/pan or axis rescale), pull the matching envelope level
+    def _on_view_range_changed(self, *args):
+        if not self._updating_plot:
+            self._render_line()
 
     #Update time ticks for x-axis to always displays 0 and 10 when timeout occurs
     def update_time_ticks(self, max_time):
         max_time = round(max_time, 1)
+
+        #Ticks only change when the rounded max time does
+        if max_time == self._tick_max_time:
+            return
+        self._tick_max_time = max_time
         
-        if max_time <= 2:
-            step = 0.5
-        else:
-            step = 1.0
+        #About 20 labels at most, long recorded trials step in whole seconds or minutes
+        step = 0.5 if max_time <= 2 else 1.0
+        for larger in (2.0, 5.0, 10.0, 30.0, 60.0, 120.0, 300.0, 600.0, 1800.0, 3600.0):
+            if max_time / step <= 20:
+                break
+            step = larger
         
         ticks = []
         time_value = step #skip 0 label
@@ -1037,6 +1256,11 @@ class DataAcquisitionDashboard(QWidget):
         self.rate_value_label.setStyleSheet("color: #1A1A1A; font-size: 20px; font-weight: 600; background: transparent; border: none;")
         card_layout.addWidget(self.rate_value_label)
 
+        #Windowed RTD from detected onset
+        self.rate_windows_label = QLabel("")
+        self.rate_windows_label.setStyleSheet("color: #666666; font-size: 11px; background: transparent; border: none;")
+        card_layout.addWidget(self.rate_windows_label)
+
         card_layout.addStretch(1)
 
         return card
@@ -1052,65 +1276,69 @@ class DataAcquisitionDashboard(QWidget):
             self.rate_value_label.setText("—")
             return
         
-        #Round to 1 decimal place
+        #Round to whole milliseconds
         try:
-            start_val = round(float(start_text), 1)
-            end_val = round(float(end_text), 1)
+            start_val = round(float(start_text), 3)
+            end_val = round(float(end_text), 3)
         except ValueError:
             self.clear_rate_lines()
             self.rate_value_label.setText("—")
             return
 
         #Clamp start to 0 min
-        max_time = max(self.time_data) if len(self.time_data) > 0 else 0
+        max_time = self.samples.last("time") if len(self.samples) > 0 else 0
         if start_val < 0:
             start_val = 0.0
-            self.rate_start_input.setText(f"{start_val:.1f}")
+            self.rate_start_input.setText(f"{start_val:.3f}")
 
         #Clamp end to max time recorded
         if end_val > max_time:
-            end_val = round(max_time, 1)
-            self.rate_end_input.setText(f"{end_val:.1f}")
+            end_val = round(max_time, 3)
+            self.rate_end_input.setText(f"{end_val:.3f}")
 
         #Valid range, calculate and draw lines
         self.calculate_rate(start_val, end_val)
         self.draw_rate_lines(start_val, end_val)
 
-    #Calculate average rate of force development
+    #Calculate average rate of torque development
     def calculate_rate(self, start_time, end_time):
+        torque = self.samples.view("force") * self.get_limb_length_m()
+        rate = torque_analysis.rate_between(self.samples.view("time"), torque, start_time, end_time)
 
-        #Reject if end is before start
-        if end_time <= start_time:
-            self.rtd = None
-            self.rate_value_label.setText("—")
-            return
-
-        time_list = list(self.time_data)
-        force_list = list(self.force_data)
-
-        #Find closest indices for start and end
-        start_index = min(range(len(time_list)), key=lambda i: abs(time_list[i] - start_time))
-        end_index = min(range(len(time_list)), key=lambda i: abs(time_list[i] - end_time))
-
-        #cannot be same
-        if start_index == end_index:
-            self.rtd = None
+        #Same sample or end before start
+        self.rtd = rate  #store for export
+        if rate is None:
             self.rate_value_label.setText("—")
             return
+        self.rate_value_label.setText(f"{rate:.2f} N·m/s")
 
-        limb_m = self.get_limb_length_m()
-        delta_torque = (force_list[end_index] - force_list[start_index]) * limb_m
-        delta_time = time_list[end_index] - time_list[start_index]
-
-        #cannot be zero
-        if delta_time == 0:
-            self.rtd = None
-            self.rate_value_label.setText("—")
+    #Detect contraction onset, fill rate inputs with onset to end of longest RTD window
+    def run_torque_analysis(self):
+        torque = self.samples.view("force") * self.get_limb_length_m()
+        self.analysis = torque_analysis.analyze_trial(self.samples.view("time"), torque)
+        analysis = self.analysis
+        if analysis.onset_time is None:
+            self.rate_windows_label.setText("No contraction onset detected")
             return
 
-        rate = delta_torque / delta_time
-        self.rtd = rate  #store for export
-        self.rate_value_label.setText(f"{rate:.2f} N·m/s")
+        #Longest window that fits in the trial, end of trial otherwise
+        end_time = self.samples.last("time")
+        for window in reversed(torque_analysis.RTD_WINDOWS):
+            if analysis.rtd_windows.get(window) is not None:
+                end_time = analysis.onset_time + window
+                break
+
+        #Set both inputs, then calculate once
+        for rate_input, value in ((self.rate_start_input, analysis.onset_time), (self.rate_end_input, end_time)):
+            rate_input.blockSignals(True)
+            rate_input.setText(f"{value:.3f}")
+            rate_input.blockSignals(False)
+        self.on_rate_input_changed()
+
+        windows = "  ".join(f"{window * 1000:.0f} ms: {rate:.0f}" if rate is not None else f"{window * 1000:.0f} ms: —"
+                            for window, rate in analysis.rtd_windows.items())
+        slope = f"{analysis.peak_slope:.0f}" if analysis.peak_slope is not None else "—"
+        self.rate_windows_label.setText(f"Onset {analysis.onset_time:.3f} s  |  {windows}  |  Peak slope {slope} N·m/s")
 
     #Draw rate lines on plot
     def draw_rate_lines(self, start_time, end_time):
@@ -1134,6 +1362,162 @@ class DataAcquisitionDashboard(QWidget):
             self.plot_widget.removeItem(self.rate_end_line)
             self.rate_end_line = None
 
+    #Ping the device every interval seconds while acquiring, results appended to log_path (JSON lines) after each trial
+    def enable_latency_probe(self, interval, log_path=None):
+        self.latency_probe = LatencyProbe()
+        self.latency_log = log_path
+        self.pipeline.latency_probe = self.latency_probe
+        self.ping_timer.setInterval(int(interval * 1000))
+        print(f"Latency probe every {interval:.3f} s")
+
+    #Print probe results of the trial and append them to the log
+    def _save_latency_probe(self):
+        print(self.latency_probe.report())
+        if not self.latency_log:
+            return
+        config = {
+            "sample_rate": self.sample_rate,
+            "frame_rate": self.render_frame_rate,
+            "filters": [type(f).__name__ for f in self.pipeline.filters],
+            "interval": self.ping_timer.interval() / 1000.0,
+        }
+        try:
+            os.makedirs(os.path.dirname(self.latency_log), exist_ok=True)
+            self.latency_probe.save(self.latency_log, self.connection_type, config)
+            print(f"Latency results appended to {self.latency_log}")
+        except OSError as e:
+            print(f"Latency results not saved: {str(e)}")
+
+    #Draw gap and stall markers across the y range, picks up markers added since the last frame
+    def update_gap_markers(self, y_min, y_max):
+        self.gap_times.extend(gap_time for gap_time, _ in self.pipeline.gaps_since(len(self.gap_times)))
+        self.stall_times.extend(stall_time for stall_time, _ in self.pipeline.monitor.stalls_since(len(self.stall_times)))
+        for markers, times in ((self.gap_markers, self.gap_times), (self.stall_markers, self.stall_times)):
+            if times:
+                markers.setData(np.repeat(times, 2), np.tile([y_min, y_max], len(times)))
+
+    #Clear gap and stall markers
+    def clear_gap_markers(self):
+        self.gap_times = []
+        self.stall_times = []
+        self.gap_markers.setData([], [])
+        self.stall_markers.setData([], [])
+
+    #Spectrum button toggled, draw at once so the panel is not empty until the next frame
+    def on_spectrum_toggled(self, checked):
+        self.spectrum_widget.setVisible(checked)
+        if checked:
+            self.update_filter_markers()
+            self.update_spectrum()
+
+    #Add newly completed FFT segments of the stored raw and filtered force, only while the panel is shown
+    #Costs at most a few FFTs per frame, independent of trial length
+    def update_spectrum(self):
+        if not self.spectrum_button.isChecked():
+            return
+        #Copy only the samples not yet analysed under the lock, FFTs run on the copies so the worker is not held up
+        with self.pipeline.lock:
+            first_index = self.samples.first_index
+            end = first_index + len(self.samples)
+            raw_start = self.raw_spectrum.tail_start(first_index, end)
+            filtered_start = self.filtered_spectrum.tail_start(first_index, end)
+            raw = self.samples.view("raw_force")[raw_start - first_index:].copy()
+            filtered = self.samples.view("force")[filtered_start - first_index:].copy()
+        raw_changed = self.raw_spectrum.update(raw, raw_start)
+        filtered_changed = self.filtered_spectrum.update(filtered, filtered_start)
+        frequencies = self.raw_spectrum.frequencies
+        if raw_changed:
+            self.raw_spectrum_line.setData(frequencies, self.raw_spectrum.psd_db)
+        if filtered_changed:
+            self.filtered_spectrum_line.setData(frequencies, self.filtered_spectrum.psd_db)
+        if raw_changed or filtered_changed:
+            #Top 100 dB of both spectra, markers follow the range
+            top = float(max(self.raw_spectrum.psd_db.max(), self.filtered_spectrum.psd_db.max())) + 5.0
+            self.spectrum_y_range = (top - 100.0, top)
+            self.spectrum_plot.setYRange(*self.spectrum_y_range, padding=0)
+            self.update_filter_markers()
+            peak = self.raw_spectrum.peak_frequency(low=5.0)
+            self.spectrum_label.setText("Power spectrum of the newest samples: raw (grey), filtered (blue)" +
+                                        (f"  |  strongest raw component above 5 Hz: {peak:.1f} Hz" if peak is not None else ""))
+
+    #Mark notch frequencies and Butterworth cutoff of the active filters
+    def update_filter_markers(self):
+        frequencies = []
+        for f in self.pipeline.filters:
+            frequencies.extend(getattr(f, "target_frequencies", []))
+            if hasattr(f, "cutoff"):
+                frequencies.append(f.cutoff)
+        if not frequencies:
+            self.filter_markers.setData([], [])
+            return
+        self.filter_markers.setData(np.repeat(frequencies, 2), np.tile(self.spectrum_y_range, len(frequencies)))
+
+    #Sample rate of the data shown, device=True also makes it the rate live trials return to
+    #Store capacity, filters and spectra follow the new rate, only call while not acquiring
+    def set_sample_rate(self, sample_rate, device=False):
+        if device:
+            self.device_sample_rate = sample_rate
+        if sample_rate == self.sample_rate:
+            return
+        self.sample_rate = sample_rate
+        self.max_data_points = int(self.sample_rate * self.max_duration)
+        with self.pipeline.lock:
+            self.pipeline.sample_rate = sample_rate
+            for f in self.pipeline.filters:
+                if hasattr(f, "set_sample_rate"):
+                    f.set_sample_rate(sample_rate)
+        self.stats_sample_rate.setText(f"{sample_rate} Hz")
+        self.raw_spectrum = SpectrumAnalyzer(sample_rate)
+        self.filtered_spectrum = SpectrumAnalyzer(sample_rate)
+        self.spectrum_plot.setXRange(0, sample_rate / 2.0, padding=0)
+        self.clear_spectrum()
+
+    #Forget spectra of the previous trial
+    def clear_spectrum(self):
+        self.raw_spectrum.reset()
+        self.filtered_spectrum.reset()
+        self.raw_spectrum_line.setData([], [])
+        self.filtered_spectrum_line.setData([], [])
+
+    #Sample columns, read directly only while not acquiring
+    @property
+    def samples(self):
+        return self.pipeline.samples
+
+    #Samples stored this trial
+    @property
+    def data_point_count(self):
+        return self.pipeline.sample_count
+
+    #Zero offset and piecewise calibration are applied on the pipeline worker
+    @property
+    def zero_offset(self):
+        return self.pipeline.zero_offset
+
+    @zero_offset.setter
+    def zero_offset(self, offset):
+        self.pipeline.zero_offset = offset
+
+    @property
+    def piecewise_cal(self):
+        return self.pipeline.piecewise_cal
+
+    @piecewise_cal.setter
+    def piecewise_cal(self, calibration):
+        self.pipeline.piecewise_cal = calibration
+
+    #Window closing, stop pipeline worker thread before it is destroyed
+    def closeEvent(self, event):
+        self.render_scheduler.timer.stop()
+        self.pipeline_worker.stop()
+        self._close_session()
+        super().closeEvent(event)
+
+    #Set plot refresh rate (frames per second)
+    def set_render_frame_rate(self, frame_rate):
+        self.render_frame_rate = frame_rate
+        self.render_scheduler.set_frame_rate(frame_rate)
+
     #Read limb length from settings, convert to meters, 0.5 m default
     def get_limb_length_m(self):
         if self.settings_window is None:
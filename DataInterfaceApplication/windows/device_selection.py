@@ -29,12 +29,13 @@ class DeviceSelection(QDialog):
 
         #Create worker based on connection type
         if self.connection_type == "bluetooth":
-            self.worker = BluetoothWorker()
+            self.worker = BluetoothWorker.shared()  #same BLE event loop thread as the connection
         else:
             self.worker = USBWorker()
         
         self.worker.scan_complete.connect(self.on_scan_complete)
         self.worker.error.connect(self.on_error)
+        self.finished.connect(self._release_worker)
 
         self.init_ui()
 
@@ -315,6 +316,14 @@ class DeviceSelection(QDialog):
         else:
             self.worker.scan()
 
+    #Dialog closed, stop listening to the shared worker
+    def _release_worker(self):
+        try:
+            self.worker.scan_complete.disconnect(self.on_scan_complete)
+            self.worker.error.disconnect(self.on_error)
+        except TypeError:
+            pass
+
     #When scan completes
     def on_scan_complete(self, found_devices):
         self.is_scanning = False
@@ -0,0 +1,405 @@
+"""
+Multi Device Dashboard - Several devices acquired at once, drawn on one aligned timeline
+One line per device, shifted and rate corrected by each device's clock alignment,
+with a card per device showing connection, samples, lost samples and alignment.
+Each trial is recorded to one session file per device.
+Filters are chosen here (same filters as the settings window), every device runs its own copies:
+causal while acquiring, zero-phase over the whole trial after stop.
+"""
+
+from PyQt6.QtWidgets import (QWidget, QLabel, QPushButton, QVBoxLayout, QHBoxLayout, QFrame, QLineEdit, QCheckBox)
+from PyQt6.QtCore import pyqtSignal
+import pyqtgraph as pg
+from utils.multi_device_acquisition import MultiDeviceAcquisition
+from utils.render_scheduler import RenderScheduler
+from utils.notch_filter import NotchFilter
+from utils.butterworth_filter import ButterworthFilter
+from utils.moving_average_filter import MovingAverageFilter
+
+DEVICE_COLORS = ("#2196F3", "#E91E63", "#4CAF50", "#FF9800", "#9C27B0", "#009688")
+
+BUTTON_STYLE = """
+    QPushButton {
+        background-color: %s;
+        color: %s;
+        border: %s;
+        border-radius: 2px;
+        padding: 7px 12px;
+        font-size: 12px;
+        margin: 0px;
+    }
+"""
+ACTIVE_BUTTON = BUTTON_STYLE % ("#1A1A1A", "white", "none")
+INACTIVE_BUTTON = BUTTON_STYLE % ("#F5F5F5", "#666666", "1px solid #E0E0E0")
+
+CHECKBOX_STYLE = """
+    QCheckBox {
+        color: #1A1A1A;
+        font-size: 12px;
+        font-weight: 500;
+    }
+    QCheckBox::indicator {
+        width: 16px;
+        height: 16px;
+        border: 1px solid #CCCCCC;
+        border-radius: 3px;
+        background-color: #FFFFFF;
+    }
+    QCheckBox::indicator:checked {
+        background-color: #1A1A1A;
+        border: 1px solid #1A1A1A;
+    }
+"""
+INPUT_STYLE = """
+    QLineEdit {
+        background-color: #F5F5F5;
+        border: 1px solid #E0E0E0;
+        border-radius: 3px;
+        padding: 6px 10px;
+        font-size: 12px;
+        color: #1A1A1A;
+    }
+"""
+
+#Multi-device dashboard screen
+class MultiDeviceDashboard(QWidget):
+
+    #Define signals
+    disconnect_request = pyqtSignal()
+
+    #Initialize with device specs (see multi_device_acquisition.py), calibration, session folder
+    #and limb length in m (from settings), editable in the window before each trial
+    def __init__(self, specs, calibration=None, session_dir=None, sample_rate=1200, limb_length_m=0.50):
+        super().__init__()
+        self.calibration = calibration
+        self.session_dir = session_dir
+        self.sample_rate = sample_rate
+        self.limb_length_m = limb_length_m
+        self.filters = []       #settings of the active filters, every device gets its own copies
+        self.is_acquiring = False
+
+        #One redraw per frame whichever device delivered, workers only mark the scheduler dirty
+        self.render_frame_rate = 30  # Hz
+        self.render_scheduler = RenderScheduler(self.update_plot, frame_rate=self.render_frame_rate)
+        self.acquisition = MultiDeviceAcquisition(specs, sample_rate=sample_rate,
+                                                  on_processed=self.render_scheduler.mark_dirty)
+        self.acquisition.device_connected.connect(self.on_device_connected)
+
+        self.init_ui()
+        self.acquisition.connect_all()
+
+    #Initialize UI
+    def init_ui(self):
+        self.setWindowTitle("LSMD Data Interface - Multi-Device Acquisition")
+        self.setMinimumSize(1100, 700)
+
+        main_layout = QVBoxLayout(self)
+        main_layout.setContentsMargins(0, 0, 0, 30)
+        main_layout.setSpacing(0)
+
+        self.create_top_bar(main_layout)
+
+        content_layout = QVBoxLayout()
+        content_layout.setContentsMargins(20, 20, 20, 20)
+        content_layout.setSpacing(20)
+
+        title = QLabel("Multi-Device Acquisition")
+        title.setStyleSheet("font-size: 24px; font-weight: 600;")
+        subtitle = QLabel("Concurrent devices on a shared, clock aligned timeline")
+        subtitle.setStyleSheet("font-size: 14px; color: #666666;")
+        content_layout.addWidget(title)
+        content_layout.addWidget(subtitle)
+
+        self.create_device_cards(content_layout)
+        self.create_controls(content_layout)
+        self.create_graph_display(content_layout)
+
+        main_layout.addLayout(content_layout)
+
+    #Top bar, device count, disconnect
+    def create_top_bar(self, layout):
+        bar = QWidget()
+        bar.setStyleSheet("""
+            QWidget {
+                background-color: #3A3A3A;
+                border-radius: 0px;
+            }
+        """)
+        bar_layout = QHBoxLayout(bar)
+        bar_layout.setContentsMargins(5, 6, 5, 6)
+
+        self.status_indicator = QLabel(f"{len(self.acquisition.streams)} Devices")
+        self.status_indicator.setStyleSheet("""
+            QLabel {
+                background-color: #6F42C1;
+                color: white;
+                padding: 6px 14px;
+                border-radius: 4px;
+                font-size: 11px;
+                font-weight: 600;
+            }
+        """)
+        bar_layout.addWidget(self.status_indicator)
+        bar_layout.addStretch(1)
+
+        self.disconnect_button = QPushButton("Disconnect")
+        self.disconnect_button.setMinimumHeight(32)
+        self.disconnect_button.setStyleSheet("""
+            QPushButton {
+                background-color: #DC3545;
+                color: white;
+                border: none;
+                border-radius: 4px;
+                padding: 6px 14px;
+                font-size: 11px;
+                font-weight: 600;
+            }
+        """)
+        self.disconnect_button.clicked.connect(self.disconnect_request.emit)
+        bar_layout.addWidget(self.disconnect_button)
+        layout.addWidget(bar)
+
+    #One card per device: colour, name, connection state, samples and alignment
+    def create_device_cards(self, layout):
+        cards_layout = QHBoxLayout()
+        cards_layout.setSpacing(16)
+        self.device_status_labels = []
+        self.device_stats_labels = []
+
+        for number, stream in enumerate(self.acquisition.streams):
+            card = QFrame()
+            card.setStyleSheet("""
+            QFrame {
+                background-color: #FFFFFF;
+                border: 1px solid #E0E0E0;
+                border-radius: 8px;
+            }
+            """)
+            card_layout = QVBoxLayout(card)
+            card_layout.setContentsMargins(16, 12, 16, 12)
+            card_layout.setSpacing(4)
+
+            color = DEVICE_COLORS[number % len(DEVICE_COLORS)]
+            name = QLabel(f"● {stream.name}  {stream.target}")
+            name.setStyleSheet(f"color: {color}; font-size: 12px; font-weight: 600; border: none;")
+            status = QLabel("Connecting...")
+            status.setStyleSheet("color: #666666; font-size: 11px; border: none;")
+            stats = QLabel("0 samples")
+            stats.setStyleSheet("color: #1A1A1A; font-size: 14px; font-weight: 600; border: none;")
+
+            card_layout.addWidget(name)
+            card_layout.addWidget(status)
+            card_layout.addWidget(stats)
+            cards_layout.addWidget(card, 1)
+            self.device_status_labels.append(status)
+            self.device_stats_labels.append(stats)
+
+        layout.addLayout(cards_layout)
+
+    #Start, stop and clear
+    def create_controls(self, layout):
+        controls = QHBoxLayout()
+        controls.setSpacing(8)
+
+        self.start_button = QPushButton("Start")
+        self.start_button.clicked.connect(self.on_start_clicked)
+        self.stop_button = QPushButton("Stop")
+        self.stop_button.clicked.connect(self.on_stop_clicked)
+        clear_button = QPushButton("Clear Data")
+        clear_button.setStyleSheet(INACTIVE_BUTTON)
+        clear_button.clicked.connect(self.on_clear_data_clicked)
+
+        #Limb length for torque, same units and check as the settings window
+        limb_label = QLabel("Limb Length (cm)")
+        limb_label.setStyleSheet("color: #1A1A1A; font-size: 12px; font-weight: 500;")
+        self.limb_length_input = QLineEdit(f"{self.limb_length_m * 100.0:g}")
+        self.limb_length_input.setStyleSheet(INPUT_STYLE)
+        self.limb_length_input.setMaximumWidth(80)
+        self.limb_length_input.editingFinished.connect(self.on_limb_length_changed)
+
+        #Filters, same order and defaults as the settings window
+        self.notch_checkbox = QCheckBox("Notch")
+        self.butterworth_checkbox = QCheckBox("Butterworth (Hz)")
+        self.cutoff_input = QLineEdit("100")
+        self.cutoff_input.setStyleSheet(INPUT_STYLE)
+        self.cutoff_input.setMaximumWidth(60)
+        self.moving_average_checkbox = QCheckBox("Moving Average")
+        for checkbox in (self.notch_checkbox, self.butterworth_checkbox, self.moving_average_checkbox):
+            checkbox.setStyleSheet(CHECKBOX_STYLE)
+            checkbox.toggled.connect(self.on_filter_settings_changed)
+        self.cutoff_input.editingFinished.connect(self.on_filter_settings_changed)
+
+        controls.addWidget(self.start_button)
+        controls.addWidget(self.stop_button)
+        controls.addWidget(clear_button)
+        controls.addStretch(1)
+        controls.addWidget(self.notch_checkbox)
+        controls.addWidget(self.butterworth_checkbox)
+        controls.addWidget(self.cutoff_input)
+        controls.addWidget(self.moving_average_checkbox)
+        controls.addSpacing(16)
+        controls.addWidget(limb_label)
+        controls.addWidget(self.limb_length_input)
+        self.update_button_styles()
+        layout.addLayout(controls)
+
+    #Plot with one line per device
+    def create_graph_display(self, layout):
+        self.plot_widget = pg.PlotWidget()
+        self.plot_widget.setBackground('#FAFAFA')
+        self.plot_widget.showGrid(x=True, y=True, alpha=0.2)
+        self.plot_widget.setLabel('bottom', 'Time (s)')
+        self.plot_widget.setLabel('left', 'Torque (N·m)')
+        self.plot_widget.setLimits(xMin=0)
+        self.plot_widget.setMouseEnabled(x=False, y=False)
+        self.plot_widget.setMenuEnabled(False)
+        self.plot_widget.setYRange(0, 500, padding=0)
+
+        self.lines = [self.plot_widget.plot([], [], pen=pg.mkPen(color=DEVICE_COLORS[number % len(DEVICE_COLORS)], width=2))
+                      for number in range(len(self.acquisition.streams))]
+        layout.addWidget(self.plot_widget, 1)
+
+    #Connection result of one device
+    def on_device_connected(self, number, success):
+        self.device_status_labels[number].setText("Connected" if success else "Connection failed")
+
+    #Start clicked, every connected device starts a trial
+    def on_start_clicked(self):
+        if self.is_acquiring:
+            return
+        if not any(stream.is_connected for stream in self.acquisition.streams):
+            print("No device connected")
+            return
+        self.limb_length_m = self.get_limb_length_m()
+        self.acquisition.start(self.calibration, self.limb_length_m, self.filters, self.session_dir)
+        self.is_acquiring = True
+        for stream, status in zip(self.acquisition.streams, self.device_status_labels):
+            if stream.acquiring:
+                status.setText("Recording")
+        self.update_button_styles()
+        self.render_scheduler.start()
+        print("Multi-device acquisition started")
+
+    #Stop clicked, devices stop and their sessions are saved with the alignment
+    def on_stop_clicked(self):
+        if not self.is_acquiring:
+            return
+        self.acquisition.stop()
+        self.render_scheduler.stop()
+        self.is_acquiring = False
+        #Replace live causal filtering with zero-phase pass over the whole trial
+        if self.filters:
+            self.acquisition.set_filters(self.filters)
+        for stream, status in zip(self.acquisition.streams, self.device_status_labels):
+            status.setText("Stopped" if stream.is_connected else status.text())
+        self.update_button_styles()
+        self.update_plot()
+        print("Multi-device acquisition stopped")
+
+    #Clear all lines and stored data
+    def on_clear_data_clicked(self):
+        if self.is_acquiring:
+            return
+        for stream, line, stats in zip(self.acquisition.streams, self.lines, self.device_stats_labels):
+            stream.pipeline.reset()
+            line.setData([], [])
+            stats.setText("0 samples")
+
+    #Redraw every device on the shared timeline
+    def update_plot(self):
+        streams = self.acquisition.streams
+        alignment = [entry or (0.0, 0.0) for entry in self.acquisition.alignment()]
+
+        #Shared end time first so every line is drawn for the new range
+        end = 1.0
+        for stream, (shift, skew) in zip(streams, alignment):
+            with stream.pipeline.lock:
+                last = stream.pipeline.samples.last("time")
+            if last is not None:
+                end = max(end, shift + last * (1.0 + skew))
+        if self.is_acquiring:
+            self.plot_widget.setXRange(0, end, padding=0)
+
+        (view_start, view_end), _ = self.plot_widget.getViewBox().viewRange()
+        max_points = 2 * max(int(self.plot_widget.width()), 100)
+        torque_min, torque_max = None, None
+        for stream, line, stats, (shift, skew) in zip(streams, self.lines, self.device_stats_labels, alignment):
+            scale = 1.0 + skew
+            snapshot = stream.pipeline.snapshot((view_start - shift) / scale, (view_end - shift) / scale, max_points)
+            line.setData(shift + snapshot.line_x * scale, snapshot.line_y)
+            if snapshot.torque_max is not None:
+                torque_min = snapshot.torque_min if torque_min is None else min(torque_min, snapshot.torque_min)
+                torque_max = snapshot.torque_max if torque_max is None else max(torque_max, snapshot.torque_max)
+
+            lost = stream.pipeline.samples_lost
+            text = f"{snapshot.sample_count} samples" + (f" ({lost} lost)" if lost else "")
+            if stream.pipeline.clock.estimate() is not None:
+                text += f"  |  shift {shift * 1000:+.1f} ms, skew {skew * 1e6:+.0f} ppm"
+            stats.setText(text)
+
+        if torque_max is not None:
+            margin = (torque_max - torque_min) * 0.1 if torque_max > torque_min else 10
+            self.plot_widget.setYRange(max(0, torque_min - margin), torque_max + margin)
+
+    #Filter checkbox or cutoff changed, applied to every device (re-filters recorded trials when stopped)
+    def on_filter_settings_changed(self):
+        self.filters = self.get_active_filters()
+        self.acquisition.set_filters(self.filters)
+        if not self.is_acquiring:
+            self.update_plot()
+
+    #Filters selected in the controls, a cutoff that is not a number falls back to 100 Hz as in settings
+    def get_active_filters(self):
+        filters = []
+        if self.notch_checkbox.isChecked():
+            filters.append(NotchFilter(sample_rate=self.sample_rate))
+        if self.butterworth_checkbox.isChecked():
+            try:
+                cutoff = float(self.cutoff_input.text().strip())
+            except ValueError:
+                cutoff = 100.0
+            if not 0 < cutoff < self.sample_rate / 2.0:
+                cutoff = 100.0
+            self.cutoff_input.setText(f"{cutoff:g}")
+            filters.append(ButterworthFilter(cutoff=cutoff, sample_rate=self.sample_rate))
+        if self.moving_average_checkbox.isChecked():
+            filters.append(MovingAverageFilter())
+        return filters
+
+    #Limb length changed, positive values only
+    def on_limb_length_changed(self):
+        try:
+            value = float(self.limb_length_input.text().strip())
+            if value <= 0:
+                raise ValueError
+        except ValueError:
+            self.limb_length_input.setText(f"{self.limb_length_m * 100.0:g}")
+            return
+        #Recorded trials are redrawn with the new length, running trials keep theirs
+        if not self.is_acquiring:
+            self.limb_length_m = value / 100.0
+            for stream in self.acquisition.streams:
+                stream.pipeline.set_limb_length(self.limb_length_m)
+            self.update_plot()
+
+    #Limb length input in m, last valid value if the text is not a number
+    def get_limb_length_m(self):
+        try:
+            value = float(self.limb_length_input.text().strip()) / 100.0
+        except ValueError:
+            return self.limb_length_m
+        return value if value > 0 else self.limb_length_m
+
+    #Highlight start or stop
+    def update_button_styles(self):
+        self.start_button.setStyleSheet(ACTIVE_BUTTON if self.is_acquiring else INACTIVE_BUTTON)
+        self.stop_button.setStyleSheet(INACTIVE_BUTTON if self.is_acquiring else ACTIVE_BUTTON)
+
+    #Stop devices and threads on close
+    def closeEvent(self, event):
+        self.render_scheduler.timer.stop()
+        if self.is_acquiring:
+            self.acquisition.stop()
+            self.is_acquiring = False
+        self.acquisition.close()
+        super().closeEvent(event)
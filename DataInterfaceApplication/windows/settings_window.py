@@ -30,6 +30,11 @@ class SettingsWindow(QWidget):
         self.port_name = port_name
         self.baud_rate = baud_rate
 
+        #Filter objects reused between get_active_filters() calls, created on first use
+        self.notch_filter = None
+        self.butterworth_filter = None
+        self.moving_average_filter = None
+
         self.init_ui()
 
     def init_ui(self):
@@ -114,6 +119,18 @@ class SettingsWindow(QWidget):
                     font-weight: 600;
                 }
             """)
+        elif self.connection_type == "replay":
+            self.status_indicator = QLabel("Replay")
+            self.status_indicator.setStyleSheet("""
+                QLabel {
+                    background-color: #6F42C1;
+                    color: white;
+                    padding: 6px 14px;
+                    border-radius: 4px;
+                    font-size: 11px;
+                    font-weight: 600;
+                }
+            """)
         else:
             self.status_indicator = QLabel("USB Connected")
             self.status_indicator.setStyleSheet("""
@@ -427,8 +444,13 @@ class SettingsWindow(QWidget):
     def get_active_filters(self, sample_rate):
         filters = []
         #Order: Notch, Butterworth, Moving Average
+        #Same objects are returned each call, only parameters that changed are updated
         if self.notch_row.checkbox.isChecked():
-            filters.append(NotchFilter(sample_rate=sample_rate))
+            if self.notch_filter is None:
+                self.notch_filter = NotchFilter(sample_rate=sample_rate)
+            elif self.notch_filter.sample_rate != sample_rate:
+                self.notch_filter.set_sample_rate(sample_rate)
+            filters.append(self.notch_filter)
         
         if self.butterworth_row.checkbox.isChecked():
             cutoff_text = self.butterworth_row.input_box.text().strip()
@@ -436,10 +458,19 @@ class SettingsWindow(QWidget):
                 cutoff = float(cutoff_text) if cutoff_text else 100.0
             except ValueError:
                 cutoff = 100.0
-            filters.append(ButterworthFilter(cutoff=cutoff, sample_rate=sample_rate))
+            if self.butterworth_filter is None:
+                self.butterworth_filter = ButterworthFilter(cutoff=cutoff, sample_rate=sample_rate)
+            else:
+                if self.butterworth_filter.cutoff != cutoff:
+                    self.butterworth_filter.set_cutoff(cutoff)
+                if self.butterworth_filter.sample_rate != sample_rate:
+                    self.butterworth_filter.set_sample_rate(sample_rate)
+            filters.append(self.butterworth_filter)
 
         if self.moving_average_row.checkbox.isChecked():
-            filters.append(MovingAverageFilter())
+            if self.moving_average_filter is None:
+                self.moving_average_filter = MovingAverageFilter()
+            filters.append(self.moving_average_filter)
 
         return filters
     
@@ -3,6 +3,7 @@
 *******************************************************************************/
 
 #include <string.h>
+#include <stdio.h>          // snprintf
 #include "command.h"
 #include "adc.h"
 #include "i2c_slave_comms.h"
@@ -106,4 +107,17 @@ void Command_Dispatch(const char *cmd, CMD_Source_t source)
             I2C_SlaveComms_Send((uint16_t)ADC_GetLastAverage());
         }
     }
+    else if (strncmp(cmd, "ping", 4U) == 0 && (cmd[4] == '\0' || cmd[4] == ' '))
+    {
+        // Latency probe: echo the host's token on the same UART as the
+        // samples, so the reply lands between the samples taken before and
+        // after the command was handled. Sampling state is not touched.
+        // The token (with its leading space) is bounded to 21 characters so
+        // the closing CRLF always fits: 6 + 21 + 2 + NUL = 30 <= 32. An
+        // unbounded token made snprintf cut the CRLF off, and the host, which
+        // reads replies line by line, never saw the pong.
+        char reply[32];
+        snprintf(reply, sizeof(reply), "\r\npong%.21s\r\n", &cmd[4]);
+        sendFn(reply);
+    }
 }
\ No newline at end of file
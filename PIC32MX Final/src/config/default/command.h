@@ -77,9 +77,12 @@ void Command_Init(void);
  *            Caller must strip the newline before calling. Must not be NULL.
  *   source - Which peripheral this command arrived on (see CMD_Source_t)
  *
- * Supported commands (case-sensitive, no whitespace):
- *   "start"  ->  LED on,  ADC sampling begins, ADC value sent over I2C
- *   "stop"   ->  LED off, ADC sampling stops,  ADC value sent over I2C
+ * Supported commands (case-sensitive, no whitespace except after "ping"):
+ *   "start"       ->  LED on,  ADC sampling begins, ADC value sent over I2C
+ *   "stop"        ->  LED off, ADC sampling stops,  ADC value sent over I2C
+ *   "ping <tok>"  ->  replies "\r\npong <tok>\r\n" on the source UART, inline
+ *                     with any samples being streamed (host latency probe);
+ *                     tokens longer than 20 characters are truncated
  *
  * Unknown or empty commands are silently discarded.
  */